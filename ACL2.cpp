@@ -49,7 +49,11 @@
 /* ------------------------------------------------------------ */
 
 #include <ACL2.h>
+#include <ACL2decode.h>
+#include <ACL2capture.h>
 #include <deque>
+#include <string.h>
+#include <stddef.h>
 
 using namespace std;
 extern "C" {
@@ -62,6 +66,57 @@ extern "C" {
 /* Instantiate a single static instance of this object class
 */
 
+/* ------------------------------------------------------------ */
+/*				Local Definitions								*/
+/* ------------------------------------------------------------ */
+
+//configuration registers kept in the shadow copy
+#define SHADOW_FIRST	THRESH_ACT_L
+#define SHADOW_LAST		SELF_TEST
+
+//bits the ADXL362 implements in each shadowed register, unused bits read back as 0
+static const uint8_t shadowMask[] = {
+	0xFF,	//THRESH_ACT_L
+	0x07,	//THRESH_ACT_H
+	0xFF,	//TIME_ACT
+	0xFF,	//THRESH_INACT_L
+	0x07,	//THRESH_INACT_H
+	0xFF,	//TIME_INACT_L
+	0xFF,	//TIME_INACT_H
+	0x3F,	//ACT_INACT_CTL
+	0x0F,	//FIFO_CONTROL
+	0xFF,	//FIFO_SAMPLES
+	0xFF,	//INTMAP1
+	0xFF,	//INTMAP2
+	0xDF,	//FILTER_CTL
+	0x7F,	//POWER_CTL
+	0x01	//SELF_TEST
+};
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Dispatch								*/
+/* ------------------------------------------------------------ */
+/* attachInterrupt() takes plain functions, so each interrupt number
+** has a small handler that forwards to the ACL2 attached to it
+*/
+static ACL2* interruptOwner[ACL2_MAX_INTERRUPTS];
+
+static void dispatchInterrupt(int n){
+	if(interruptOwner[n] != 0){
+		interruptOwner[n]->serviceInterrupt();
+	}
+}
+
+static void interrupt0(){ dispatchInterrupt(0); }
+static void interrupt1(){ dispatchInterrupt(1); }
+static void interrupt2(){ dispatchInterrupt(2); }
+static void interrupt3(){ dispatchInterrupt(3); }
+static void interrupt4(){ dispatchInterrupt(4); }
+
+static void (* const interruptHandler[])() = {
+	interrupt0, interrupt1, interrupt2, interrupt3, interrupt4
+};
+
 
 
 /* ------------------------------------------------------------ */
@@ -80,6 +135,30 @@ extern "C" {
 **    Constructor to the class ACL2
 */
 ACL2::ACL2(){	
+	bus = 0;
+	resetShadow();
+	filterConfig = SENSOR_RANGE_8;
+	powerConfig = BEGIN_MEASURE;
+	spiClock = ACL2_SPI_CLOCK;
+	range = 8;
+	scale = 4;
+	interrupt = -1;
+	startupTime = 0;
+	setSize = 3;
+	pendingNext = 0;
+	tempDecimation = 0;
+	tempCountdown = 0;
+	heldTemp = 0;
+	resetTiming();
+	resetLoss();
+	lastDrain = 0;
+	drainRemaining = 0;
+	draining = false;
+	dropping = false;
+	capture = 0;
+	lockDepth = 0;
+	drainPending = false;
+	resetStats();
 }
 
 /* ------------------------------------------------------------ */
@@ -97,10 +176,35 @@ ACL2::ACL2(){
 **
 **  Description:
 **   	initializes the class parameters and calls for the IC to be initialized
+**		over the Arduino SPI library
 */
+#if ACL2_ARDUINO_SPI
 void ACL2::begin(int CS){	
-	SPI.begin();
-	chipSelect = CS;
+	arduinoBus.setChipSelect(CS);
+	begin(&arduinoBus);
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**    transport - bus the ACL2 is on, must stay valid while the object is used
+**
+**  Return Value:
+**    bool - true if the transport started and the ACL2 came out of reset
+**
+**  Errors:
+**    returns false without touching the ACL2 if transport->begin() fails
+**
+**  Description:
+**   	same as begin(CS) for a part on any ACL2transport, e.g. ACL2spidev on Linux
+*/
+bool ACL2::begin(ACL2transport* transport){
+	bus = transport;
+	if(!bus->begin()){
+		return false;
+	}
 		
 	//if we know the ACL2 will be at rest during start up run setZero() instead.
 	xZero = -120;
@@ -108,6 +212,8 @@ void ACL2::begin(int CS){
 	zZero = -320;
 
 	reset();
+	
+	return startupTime != 0;
 }
 
 /* ------------------------------------------------------------ */
@@ -120,30 +226,104 @@ void ACL2::begin(int CS){
 **    none
 **
 **  Errors:
-**    none
+**    if PART_ID does not read 0xF2 or no sample arrives within ACL2_STARTUP_TIMEOUT_US,
+**		getStartupTime() returns 0
 **
 **  Description:
 **   	This initializes the IC for a sensitivity of +- 8g (256 per 1g) and sets up default settings on
-** 	activity and drop detection by writing to various registers
+** 	activity and drop detection by writing to various registers. The registers are staged in the
+**		shadow copy and sent as one auto-incrementing write. init() polls PART_ID until the
+**		part answers, sleeps one output data period once measurement is on and then polls
+**		STATUS until the first sample is ready
 */
 void ACL2::init(){
 	
-  delay(10);
-  writeRegister(THRESH_INACT_L,FREE_FALL_THRESH);	  	//Sets free fall detection threshold to 600mg
-  delay(10);
-  writeRegister(TIME_INACT_L,FREE_FALL_TIME);					//Sets free-fall detection time to 30ms  
-  delay(10);
-  writeRegister(ACT_INACT_CTL,ABS_INACT_ENABLE);			//Enable absolute inactivity detect  
-  delay(10);
-  writeRegister(THRESH_INACT_H,SET_INACT_INTERUPT);	//Sets the inactivity interrupt to the interrupt pin 1
-  delay(10);  
-  writeRegister( FILTER_CTL,SENSOR_RANGE_8);					//Sets sensor range to 8g with 100Hz ODR
-  delay(10);
-  writeRegister( POWER_CTL, BEGIN_MEASURE);					//Begins measurement  
-  delay(10);
+	unsigned long start = micros();
+	
+	startupTime = 0;
+	
+	//the part answers with its ID as soon as it is out of reset
+	if(!poll(PART_ID, 0xFF, ADXL362_PART_ID, start)){
+		return;
+	}
+	
+  setRegister(THRESH_INACT_L,FREE_FALL_THRESH);	  	//Sets free fall detection threshold to 600mg
+  setRegister(TIME_INACT_L,FREE_FALL_TIME);					//Sets free-fall detection time to 30ms  
+  setRegister(ACT_INACT_CTL,ABS_INACT_ENABLE);			//Enable absolute inactivity detect  
+  setRegister(INTMAP1,SET_INACT_INTERUPT);				//Sets the inactivity interrupt to the interrupt pin 1
+  setRegister( FILTER_CTL,filterConfig);					//Sets sensor range to 8g with 100Hz ODR unless a subclass chose otherwise
+  setRegister( POWER_CTL, powerConfig);					//Begins measurement, ultralow noise unless setDataRate() chose otherwise
+  commitRegisters();													//writes THRESH_INACT_L through POWER_CTL in one transaction
 	
   updateRange();  																				//sets class range value
   
+	//no sample can land before one output data period has gone by
+	wait(odrPeriod());
+	
+	//measuring once the first conversion has landed
+	if(!poll(STATUS, STATUS_DATA_READY, STATUS_DATA_READY, start)){
+		return;
+	}
+	
+	startupTime = micros() - start;
+	if(startupTime == 0){
+		startupTime = 1;
+	}
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  poll()
+**
+**  Parameters:
+**    thisRegister - register to read
+**		mask - bits to compare
+**		value - expected value of the masked bits
+**		start - micros() value the timeout is counted from
+**
+**  Return Value:
+**    bool - true once the masked register equals value, false after ACL2_STARTUP_TIMEOUT_US
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reads a register until the masked bits match, sleeping ACL2_POLL_US between reads
+**		so the wait costs a handful of transactions rather than a tight loop of them
+*/
+bool ACL2::poll(uint8_t thisRegister, uint8_t mask, uint8_t value, unsigned long start){
+	
+	while((readRegister(thisRegister) & mask) != value){
+		if(micros() - start >= ACL2_STARTUP_TIMEOUT_US){
+			return false;
+		}
+		wait(ACL2_POLL_US);
+	}
+	
+	return true;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  getStartupTime()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    unsigned long - microseconds from the start of the last reset() or init() to the first
+**		valid sample, 0 if the ACL2 did not answer or start measuring
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reports how long the last start up took
+*/
+unsigned long ACL2::getStartupTime(){
+	
+	return startupTime;
+	
 }
 
 /* ------------------------------------------------------------ */
@@ -168,8 +348,7 @@ int ACL2::getX(){
 	result = getData(XDATA_H, XDATA_L);	
 	
 	//process to achieve desired reading
-	result = result * 1000;
-	result = result / (2000 / range);
+	result = result * scale;
 	result = result + xZero;
 	
 	return result;
@@ -198,8 +377,7 @@ int ACL2::getY(){
 	result = getData(YDATA_H, YDATA_L);
 	
 	//process to achieve desired reading
-	result = result * 1000;
-	result = result /(2000 / range);
+	result = result * scale;
 	result = result + yZero;
 	
 	return result;
@@ -228,8 +406,7 @@ int ACL2::getZ(){
 	result = getData(ZDATA_H, ZDATA_L);	
 	
 	//process to achieve desired reading
-	result = result * 1000;
-	result = result / (2000 / range);
+	result = result * scale;
 	result = result + zZero;
 	
 	return result;
@@ -258,6 +435,43 @@ int ACL2::getTemp(){
 	
 }
 
+/* ------------------------------------------------------------ */
+/*  getXYZT()
+**
+**  Parameters:
+**    ACL2sample* sample - structure to store the x, y, z and temp values in
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reads XDATA_L through TEMP_H in a single burst transaction so all four values
+**		come from the same conversion, then scales and zeroes them like getX(), getY(),
+**		getZ() and getTemp() do
+*/
+void ACL2::getXYZT(ACL2sample* sample){
+	
+	uint8_t data[8];
+	
+	//read the 8 data registers with one auto-incrementing read
+	readRegisters(XDATA_L, data, 8);
+	
+	//combine each low/high pair into a signed value
+	sample->x = decodeData((data[1] << 8) | data[0]);
+	sample->y = decodeData((data[3] << 8) | data[2]);
+	sample->z = decodeData((data[5] << 8) | data[4]);
+	sample->temp = decodeData((data[7] << 8) | data[6]);
+	
+	//process to achieve desired reading
+	sample->x = sample->x * scale + xZero;
+	sample->y = sample->y * scale + yZero;
+	sample->z = sample->z * scale + zZero;
+	
+}
+
 /* ------------------------------------------------------------ */
 /*  getStatus()
 **
@@ -318,23 +532,46 @@ uint8_t ACL2::getRange(){
 */
 uint8_t ACL2::readRegister(uint8_t thisRegister){
 	
-  uint8_t inByte = 0; //byte from register
-  
-  
-  //set cs low
-  digitalWrite((uint8_t)chipSelect, LOW);
-
-  //send instruction type
-  SPI.transfer(READ);
-  //send address of register
-  SPI.transfer(thisRegister);
-  // send a value of 0 to read the first byte returned:
-  inByte = SPI.transfer(0);
-  
-  digitalWrite(chipSelect, HIGH);
-  
-  return(inByte);   
-  
+	//instruction type, address of register, then a 0 to clock the byte out
+	uint8_t command[3] = {READ, thisRegister, 0};
+	uint8_t inBytes[3];
+	
+	select();
+	transfer(command, inBytes, 3);
+	deselect();
+	
+	return(inBytes[2]);   
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  readRegisters()
+**
+**  Parameters:
+**    firstRegister - address of the first register to read from
+**		values - array to store the bytes read
+**		count - number of consecutive registers to read
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	Reads count consecutive registers starting at firstRegister in one transaction.
+**		The ACL2 auto-increments the register address for as long as chip select is held low
+*/
+void ACL2::readRegisters(uint8_t firstRegister, uint8_t* values, int count){
+	
+	uint8_t command[2] = {READ, firstRegister};
+	
+	//send instruction type and the first address, then clock out each register
+	select();
+	transfer(command, 0, 2);
+	transfer(0, values, count);
+	deselect();
+	
 }
 
 /* ------------------------------------------------------------ */
@@ -355,28 +592,27 @@ uint8_t ACL2::readRegister(uint8_t thisRegister){
 */
 void ACL2::writeRegister(uint8_t thisRegister, uint8_t thisValue){	
 	
-	//set chip select pin low
-	digitalWrite((uint8_t)chipSelect, LOW);
-
-	//send Write instruction
-	SPI.transfer(WRITE);	
-	
-	//Send address to write to
-	SPI.transfer(thisRegister);
+	//Write instruction, address to write to and the data
+	uint8_t command[3] = {WRITE, thisRegister, thisValue};
 	
-	//Send Data to write to register
-	SPI.transfer(thisValue);  
+	select();
+	transfer(command, 0, 3);
+	deselect();	
 	
-	// take the chip select high to de-select:
-	digitalWrite(chipSelect, HIGH);	
+	//keep the shadow copy in step
+	if(thisRegister >= SHADOW_FIRST && thisRegister <= SHADOW_LAST){
+		shadow[thisRegister - SHADOW_FIRST] = thisValue;
+	}
 	
 }
 
 /* ------------------------------------------------------------ */
-/*  reset()
+/*  writeRegisters()
 **
 **  Parameters:
-**    none
+**    	firstRegister - address of the first register to write
+**		values - bytes to write
+**		count - number of consecutive registers to write
 **
 **  Return Value:
 **    none
@@ -385,115 +621,84 @@ void ACL2::writeRegister(uint8_t thisRegister, uint8_t thisValue){
 **    none
 **
 **  Description:
-**   	writes the byte 'R' to the reset register to initiate a soft reset. Then call
-**		init to set the sensor up for measurement again
+**   	writes count consecutive registers starting at firstRegister in one transaction,
+**		relying on the ACL2 auto-incrementing the address, and updates the shadow copy
 */
-void ACL2::reset(){
+void ACL2::writeRegisters(uint8_t firstRegister, const uint8_t* values, int count){	
 	
-	//write 'R' to soft reset register
-	writeRegister(SOFT_RESET, 'R');
+	uint8_t reg = 0;
+	uint8_t command[2] = {WRITE, firstRegister};
 	
-	//go through init sequence
-	init();
+	select();
+	transfer(command, 0, 2);
+	transfer(values, 0, count);
+	deselect();
+	
+	for(int i = 0; i < count; i ++){
+		reg = firstRegister + i;
+		if(reg >= SHADOW_FIRST && reg <= SHADOW_LAST){
+			shadow[reg - SHADOW_FIRST] = values[i];
+		}
+	}
 	
 }
 
 /* ------------------------------------------------------------ */
-/*  updateRange()
+/*  readShadow()
 **
 **  Parameters:
-**    none
+**    	thisRegister - configuration register address (0x20 - 0x2E)
 **
 **  Return Value:
-**    none
+**    uint8_t - the value last written to the register, 0 outside 0x20 - 0x2E
 **
 **  Errors:
 **    none
 **
 **  Description:
-**   	Reads the filter control register and stores the sensitivity range into  
-**		a private variable
+**   	returns the shadow copy of a configuration register without using the bus
 */
-void ACL2::updateRange(){
-	
-	uint8_t value;
-	value = readRegister(FILTER_CTL);
+uint8_t ACL2::readShadow(uint8_t thisRegister){
 	
-	//only looking at first two bits. 192 = 0b11000000 = 0xC0
-	value = value & 0xC0;
+	if(thisRegister < SHADOW_FIRST || thisRegister > SHADOW_LAST){
+		return 0;
+	}
+	return shadow[thisRegister - SHADOW_FIRST];
 	
-	//set range based on register value
-	switch(value){
-		case 0xC0:
-			range = 8;
-			break;
-			
-		case 0x80:
-			range = 8;
-			break;
-		
-		case 0x40:
-			range = 4;
-			break;
-		
-		case 0:
-			range = 2;
-			break;
-	}	
 }
 
 /* ------------------------------------------------------------ */
-/*  setRange()
+/*  setRegister()
 **
 **  Parameters:
-**    int newRange: The new sensitivity range for the ACL to use (2,4,8)
+**    	thisRegister - configuration register address (0x20 - 0x2E)
+**		thisValue - value to stage
 **
 **  Return Value:
 **    none
 **
 **  Errors:
-**    none
+**    registers outside 0x20 - 0x2E are ignored
 **
 **  Description:
-**   	takes in the user choice newRange and if it is valid, writes to the filter
-**		control to change the sensitivity range while keeping other filter preferences
+**   	changes a configuration register in the shadow copy only. commitRegisters()
+**		sends all staged changes in one transaction
 */
-void ACL2::setRange(int newRange){
+void ACL2::setRegister(uint8_t thisRegister, uint8_t thisValue){
 	
-	uint8_t temp = 0;
-	
-	//get range control data
-	temp = readRegister(FILTER_CTL);
-	
-	//modify the temp data to change to desired range
-	switch(newRange){
-		case 2: 
-			temp = temp & 0x3F;
-			break;
-		case 4:
-			temp = temp & 0x3F;
-			temp = temp | 0x40;
-			break;
-		case 8:
-			temp = temp | 0x80;
-			break;
-		default:
-			break;				//if not a valid range, will just set the FILTER_CTL register to what it was
+	if(thisRegister < SHADOW_FIRST || thisRegister > SHADOW_LAST){
+		return;
 	}
-	
-	//write modified temp back to FILTER_CTL
-	writeRegister(FILTER_CTL, temp);
-
-	//set class range value
-	updateRange();
+	shadow[thisRegister - SHADOW_FIRST] = thisValue;
+	shadowDirty = shadowDirty | (1 << (thisRegister - SHADOW_FIRST));
 	
 }
 
 /* ------------------------------------------------------------ */
-/*  setZero()
+/*  commitRegisters()
 **
 **  Parameters:
-**    none
+**    	none
 **
 **  Return Value:
 **    none
@@ -502,61 +707,70 @@ void ACL2::setRange(int newRange){
 **    none
 **
 **  Description:
-**   	Sets the zeroing variables so that the ACL puts out x= 0, y = 0, z = 1000
-**		has a 100 point sample
+**   	writes the span from the lowest to the highest register staged with setRegister()
+**		as a single auto-incrementing write. Unchanged registers inside the span are
+**		rewritten with their shadow values
 */
-void ACL2::setZero(){
-	//math sets the current acceleration to read zero
+void ACL2::commitRegisters(){
 	
-	int xAvg = 0;
-	int yAvg = 0;
-	int zAvg = 0;
+	int first = -1;
+	int last = -1;
 	
+	for(int i = 0; i <= SHADOW_LAST - SHADOW_FIRST; i ++){
+		if(shadowDirty & (1 << i)){
+			if(first < 0){
+				first = i;
+			}
+			last = i;
+		}
+	}
 	
-	for(int i = 0; i < 100; i ++){
-			xAvg =  xAvg + getX();
-			yAvg = yAvg + getY();
-			zAvg = zAvg + getZ();
+	if(first >= 0){
+		writeRegisters(SHADOW_FIRST + first, &shadow[first], last - first + 1);
 	}
-	xAvg = xAvg / 100;
-	yAvg = yAvg / 100;
-	zAvg = zAvg / 100;
+	shadowDirty = 0;
 	
-		
-	xZero = 0 - (xAvg - xZero);
-	yZero = 0 - (yAvg - yZero);
-	zZero = 1000 - (zAvg - zZero);	
 }
 
-
-
 /* ------------------------------------------------------------ */
-/*  getFIFOentries()
+/*  verifyRegisters()
 **
 **  Parameters:
-**    none
+**    	none
 **
 **  Return Value:
-**    int result: the number of FIFO entries stored in the buffer
+**    int - number of configuration registers whose device value differs from the shadow copy
 **
 **  Errors:
 **    none
 **
 **  Description:
-**   	This function reads the FIFO_ENTRIES registers and returns the value inside
-**		
+**   	re-reads 0x20 - 0x2E in one transaction and compares them with the shadow copy,
+**		to detect a reset or brown-out of the ACL2 that left its configuration behind.
+**		Only the bits the part implements are compared, unused bits always read back as 0
 */
-int ACL2::getFIFOentries(){
+int ACL2::verifyRegisters(){
+	
+	uint8_t device[SHADOW_LAST - SHADOW_FIRST + 1];
+	int mismatches = 0;
+	
+	readRegisters(SHADOW_FIRST, device, sizeof(device));
+	
+	for(int i = 0; i < (int)sizeof(device); i ++){
+		if((device[i] ^ shadow[i]) & shadowMask[i]){
+			mismatches ++;
+		}
+	}
+	
+	return mismatches;
 	
-	return getData(FIFO_ENTRIES_H, FIFO_ENTRIES_L);		
-
 }
 
 /* ------------------------------------------------------------ */
-/*  initFIFO()
+/*  resetShadow()
 **
 **  Parameters:
-**    none
+**    	none
 **
 **  Return Value:
 **    none
@@ -565,25 +779,24 @@ int ACL2::getFIFOentries(){
 **    none
 **
 **  Description:
-**   	This function manipulates the FIFO and control registers to start the FIFO buffer in a streaming mode
-**		
+**   	loads the shadow copy with the register values the ACL2 has after a reset
 */
-void ACL2::initFIFO(){
-
-	//set interupt1 pin to data ready
-	writeRegister(INTMAP1, 1);
+void ACL2::resetShadow(){
+	
+	for(int i = 0; i <= SHADOW_LAST - SHADOW_FIRST; i ++){
+		shadow[i] = 0;
+	}
+	shadow[FIFO_SAMPLES - SHADOW_FIRST] = 0x80;
+	shadow[FILTER_CTL - SHADOW_FIRST] = 0x13;
+	shadowDirty = 0;
 	
-	//turn on FIFO
-	writeRegister(FIFO_CONTROL, 10);
-	writeRegister(FIFO_SAMPLES, 255);		//set to 512 values for each
-
 }
 
 /* ------------------------------------------------------------ */
-/*  fillFIFO()
+/*  select()
 **
 **  Parameters:
-**	   none
+**    none
 **
 **  Return Value:
 **    none
@@ -592,207 +805,1816 @@ void ACL2::initFIFO(){
 **    none
 **
 **  Description:
-**   	This function initiates the FIFO read then reads and processes the data
-**		coming out of the FIFO buffer and places them into their respective myQueue
+**   	lowers chip select to start a transaction. Every bus access in the library
+**		goes through select(), deselect(), transfer() and wait() so that it is counted
 */
-void ACL2::fillFIFO(){		
-	
-	uint16_t buffer = 0;
-	uint16_t LSB = 0;
-	int result = 0;	
-	int sign = 0;
-	char dir = '\0';
-	int samples = 0;
-	int i = 0;
+void ACL2::select(){
 	
-	//get the number of samples
-	samples = getFIFOentries();	
+	lock();
+#if ACL2_STATS
+	stats.transactions ++;
+#endif
+	bus->select();
 	
-	if(samples > 0){
-		
-		//lower chip select and send FIFO_READ byte. 
-		//->chipSelect needs to stay low throughout the transfer
-		digitalWrite(chipSelect, LOW);
-		SPI.transfer(FIFO_READ);
-		
-		while(i < (samples)){		
-			//read the 8 LSBs in LSB buffer
-			LSB = SPI.transfer(0);
-			//read the 8 MSBs into buffer
-			buffer = SPI.transfer(0);
-			
-			//shift MSBs to correct position then OR with LSB
-			buffer = buffer << 8;
-			buffer = buffer | LSB;
-			
-			//receive axis of data
-			dir = getDIR(buffer);
-			
-			//get rid of first two directional bits
-			buffer = buffer & 0b0011111111111111;
-			
-			//check to see if value is negative and if so run through twosToBin
-			if(buffer > 8192){
-				sign = 1;
-				buffer = twosToBin(buffer);
-			}		
-			
-			//copy and mask buffer data into a signed int for storing
-			result = buffer & 0x07ff;
-			
-			//account for negative
-			if(sign == 1){
-				result = 0 - result;
-			}
-			//scales data
-			result *= (1000 / (2000 / range));
-			//processes the data and puts it into the correct myQueue according to DIR
-			if(dir == 'x'){				
-				result = result + xZero;
-				xFIFO.push_back(result);
-			}			
-			else if(dir == 'y'){				
-				result = result + yZero;
-				yFIFO.push_back(result);
-			}
-			else if(dir == 'z'){
-				result = result + zZero;
-				zFIFO.push_back(result);
-			}
-			else{
-			}
-					
-			//increment counter
-			i = i + 1;
-			
-			sign = 0;
-			dir = '\0';
-		}
-		//set chip select high again once FIFO transfer is over
-		digitalWrite(chipSelect, HIGH);
-		
-	}
-	return;
 }
 
 /* ------------------------------------------------------------ */
-/*  getData()
+/*  deselect()
 **
 **  Parameters:
-**    	reg1 - first register to read from. the high data value which contains 
-**		the 3 MSBs
-**		reg2 - second register to read from. the low data value which contains
-**		the 8 LSBs
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	raises chip select to end a transaction. Buffers passed to transfer() are
+**		only filled once this returns
+*/
+void ACL2::deselect(){
+	
+	bus->deselect();
+	unlock();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  lock()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	marks the bus as in use by this object. A FIFO interrupt that arrives while
+**		the bus is in use is remembered instead of starting a drain in the middle
+**		of a transaction
+*/
+void ACL2::lock(){
+	
+	lockDepth = lockDepth + 1;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  unlock()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	releases the bus and runs any drain that was deferred by serviceInterrupt()
+*/
+void ACL2::unlock(){
+	
+	lockDepth = lockDepth - 1;
+	
+	while(lockDepth == 0 && drainPending){
+		drainPending = false;
+		lockDepth = lockDepth + 1;
+		drainFIFO();
+		lockDepth = lockDepth - 1;
+	}
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  transfer()
+**
+**  Parameters:
+**    tx - bytes to send, 0 to send zeros
+**		rx - buffer for the bytes received, 0 to discard them
+**		count - number of bytes
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	clocks a whole buffer full duplex over the transport. The Arduino backend
+**		uses the core's block transfer, which keeps the bus busy between bytes and
+**		lets cores that support it use DMA; spidev queues it into the ioctl sent
+**		at deselect()
+*/
+void ACL2::transfer(const uint8_t* tx, uint8_t* rx, int count){
+	
+#if ACL2_STATS
+	stats.spiBytes += count;
+#endif
+	bus->transfer(tx, rx, count);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  wait()
+**
+**  Parameters:
+**    us - microseconds to wait
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	blocking delay used by the library
+*/
+void ACL2::wait(unsigned long us){
+	
+#if ACL2_STATS
+	stats.blockedUs += us;
+#endif
+	//delayMicroseconds() only covers a few milliseconds on some cores
+	delay(us / 1000);
+	delayMicroseconds(us % 1000);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  getStats()
+**
+**  Parameters:
+**    ACL2stats* out - structure to copy the counters to
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    all counters read 0 when ACL2_STATS is 0
+**
+**  Description:
+**   	copies the counters accumulated since the last resetStats() and works out the
+**		averages. The bus is locked for the copy, so a drain from the interrupt cannot
+**		change the counters half way; it runs as soon as the copy is done
+*/
+void ACL2::getStats(ACL2stats* out){
+	
+#if ACL2_STATS
+	lock();
+	*out = stats;
+	out->overruns = loss.overruns - overrunBase;
+	out->queueOverflows = loss.queueOverflows - overflowBase;
+	unlock();
+	
+	if(out->drains == 0){
+		out->drainUsMin = 0;
+	}
+	else{
+		out->framesPerDrain = out->frames / out->drains;
+		out->drainUsAvg = out->drainUsTotal / out->drains;
+	}
+#else
+	memset(out, 0, sizeof(ACL2stats));
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  resetStats()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	clears the bus and drain counters. The getLoss() counters are not changed
+*/
+void ACL2::resetStats(){
+	
+#if ACL2_STATS
+	lock();
+	memset(&stats, 0, sizeof(stats));
+	stats.drainUsMin = 0xFFFFFFFF;
+	overrunBase = loss.overruns;
+	overflowBase = loss.queueOverflows;
+	unlock();
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  reset()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	writes the byte 'R' to the reset register to initiate a soft reset. Then call
+**		init to set the sensor up for measurement again. The part ignores the bus for
+**		ACL2_RESET_US after the reset command, which is the only fixed wait on start up
+*/
+void ACL2::reset(){
+	
+	unsigned long start = micros();
+	
+	//write 'R' to soft reset register
+	writeRegister(SOFT_RESET, 'R');
+	resetShadow();
+	wait(ACL2_RESET_US);
+	
+	//go through init sequence
+	init();
+	
+	//count the reset itself in the start up time
+	if(startupTime != 0){
+		startupTime = micros() - start;
+	}
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  updateRange()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	Reads the filter control register from the shadow copy and stores the sensitivity
+**		range into a private variable
+*/
+void ACL2::updateRange(){
+	
+	uint8_t value;
+	value = readShadow(FILTER_CTL);
+	
+	//only looking at first two bits. 192 = 0b11000000 = 0xC0
+	value = value & 0xC0;
+	
+	//set range based on register value
+	switch(value){
+		case 0xC0:
+			range = 8;
+			break;
+			
+		case 0x80:
+			range = 8;
+			break;
+		
+		case 0x40:
+			range = 4;
+			break;
+		
+		case 0:
+			range = 2;
+			break;
+	}	
+	
+	//mg per LSB is range / 2, kept so the data paths multiply instead of divide
+	scale = range / 2;
+}
+
+/* ------------------------------------------------------------ */
+/*  setRange()
+**
+**  Parameters:
+**    int newRange: The new sensitivity range for the ACL to use (2,4,8)
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	takes in the user choice newRange and if it is valid, writes to the filter
+**		control to change the sensitivity range while keeping other filter preferences
+*/
+void ACL2::setRange(int newRange){
+	
+	uint8_t temp = 0;
+	
+	//get range control data, no bus read needed
+	temp = readShadow(FILTER_CTL);
+	
+	//modify the temp data to change to desired range
+	switch(newRange){
+		case 2: 
+			temp = temp & 0x3F;
+			break;
+		case 4:
+			temp = temp & 0x3F;
+			temp = temp | 0x40;
+			break;
+		case 8:
+			temp = temp | 0x80;
+			break;
+		default:
+			break;				//if not a valid range, will just set the FILTER_CTL register to what it was
+	}
+	
+	//write modified temp back to FILTER_CTL
+	writeRegister(FILTER_CTL, temp);
+
+	//set class range value
+	updateRange();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  setZero()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	Sets the zeroing variables so that the ACL puts out x= 0, y = 0, z = 1000
+**		from ACL2_CALIBRATE_FRAMES frames read out of the FIFO, see calibrate()
+*/
+void ACL2::setZero(){
+	
+	calibrate(ACL2_CALIBRATE_FRAMES);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  calibrate()
+**
+**  Parameters:
+**    frames - number of x, y, z frames to collect, at most ACL2_CALIBRATE_FRAMES
+**
+**  Return Value:
+**    int - frames that were averaged after outlier rejection, 0 on failure
+**
+**  Errors:
+**    returns 0 and leaves the offsets alone if the FIFO does not fill within
+**		twice the expected time or no aligned frame was read
+**
+**  Description:
+**   	Sets the zeroing variables so that the ACL2 at rest puts out x = 0, y = 0, z = 1000.
+**		The FIFO is cleared, refilled with fresh conversions and read in one drain, so
+**		no conversion is used twice. For each axis the median and the median absolute
+**		deviation are found and samples further than ACL2_CALIBRATE_REJECT deviations
+**		from the median are dropped before averaging. Any data waiting in the FIFO is
+**		discarded; the queues are left untouched
+*/
+int ACL2::calibrate(int frames){
+	
+	int16_t data[ACL2_CALIBRATE_FRAMES * 3];
+	uint8_t control = readShadow(FIFO_CONTROL);
+	unsigned long start = 0;
+	unsigned long timeout = 0;
+	int entries = 0;
+	int kept = 0;
+	int next = 0;
+	int count[3];
+	long sum[3];
+	uint16_t entry = 0;
+	
+	if(frames > ACL2_CALIBRATE_FRAMES){
+		frames = ACL2_CALIBRATE_FRAMES;
+	}
+	if(frames < 1){
+		return 0;
+	}
+	entries = frames * 3;
+	
+	//hold off interrupt drains until the FIFO is back the way the user had it
+	lock();
+	
+	//leaving FIFO mode clears it, x, y, z stream starts at a set boundary
+	setRegister(FIFO_CONTROL, 0);
+	commitRegisters();
+	setRegister(FIFO_CONTROL, FIFO_MODE_STREAM);
+	commitRegisters();
+	
+	//sleep through the fill instead of polling the whole time, then check back
+	//every ACL2_POLL_US for the last conversions
+	start = micros();
+	timeout = 2 * (frames + 1) * odrPeriod();
+	wait(frames * odrPeriod());
+	while(getFIFOentries() < entries){
+		if(micros() - start >= timeout){
+			setRegister(FIFO_CONTROL, control);
+			commitRegisters();
+			pendingNext = 0;
+			drainRemaining = 0;
+			draining = false;
+			lastDrain = micros();
+			unlock();
+			return 0;
+		}
+		wait(ACL2_POLL_US);
+	}
+	
+	readFIFO((uint8_t*)data, entries);
+	
+	//user FIFO restarts empty, so it also restarts at x
+	setRegister(FIFO_CONTROL, 0);
+	commitRegisters();
+	setRegister(FIFO_CONTROL, control);
+	commitRegisters();
+	pendingNext = 0;
+	drainRemaining = 0;
+	draining = false;
+	lastDrain = micros();
+	unlock();
+	
+	//decode in place, keeping only complete x, y, z sets
+	for(int i = 0; i < entries; i ++){
+		entry = ((uint8_t*)data)[2 * i] | (((uint8_t*)data)[2 * i + 1] << 8);
+		if(ACL2entryAxis(entry) != next){
+			kept = kept - next;
+			next = 0;
+			if(ACL2entryAxis(entry) != 0){
+				continue;
+			}
+		}
+		data[kept] = ACL2entryValue(entry);
+		kept ++;
+		next ++;
+		if(next == 3){
+			next = 0;
+		}
+	}
+	frames = kept / 3;
+	if(frames == 0){
+		return 0;
+	}
+	
+	for(int axis = 0; axis < 3; axis ++){
+		robustSum(&data[axis], frames, 3, &sum[axis], &count[axis]);
+	}
+	
+	//offsets are in mg, round the mean to the nearest mg
+	xZero = 0 - roundMean(sum[0] * scale, count[0]);
+	yZero = 0 - roundMean(sum[1] * scale, count[1]);
+	zZero = 1000 - roundMean(sum[2] * scale, count[2]);
+	
+	kept = count[0];
+	if(count[1] < kept){
+		kept = count[1];
+	}
+	if(count[2] < kept){
+		kept = count[2];
+	}
+	return kept;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  robustSum()
+**
+**  Parameters:
+**    values - first sample of the axis
+**		n - number of samples
+**		stride - distance between samples of the axis
+**		sum - returns the sum of the samples that were kept
+**		kept - returns the number of samples that were kept
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	sorts the samples in place, then keeps the ones within ACL2_CALIBRATE_REJECT median
+**		absolute deviations of the median. The deviation is found by walking outwards from
+**		the median of the sorted samples, so no second buffer is needed
+*/
+void ACL2::robustSum(int16_t* values, int n, int stride, long* sum, int* kept){
+	
+	int16_t value = 0;
+	int16_t median = 0;
+	int j = 0;
+	int low = 0;
+	int high = 0;
+	int mad = 0;
+	int deviation = 0;
+	
+	//insertion sort, n is at most ACL2_CALIBRATE_FRAMES
+	for(int i = 1; i < n; i ++){
+		value = values[i * stride];
+		j = i - 1;
+		while(j >= 0 && values[j * stride] > value){
+			values[(j + 1) * stride] = values[j * stride];
+			j --;
+		}
+		values[(j + 1) * stride] = value;
+	}
+	median = values[(n / 2) * stride];
+	
+	//(n / 2)th smallest distance from the median, merging both sides of the sorted list
+	low = n / 2 - 1;
+	high = n / 2 + 1;
+	for(int i = 0; i < n / 2; i ++){
+		if(high >= n || (low >= 0 && median - values[low * stride] <= values[high * stride] - median)){
+			mad = median - values[low * stride];
+			low --;
+		}
+		else{
+			mad = values[high * stride] - median;
+			high ++;
+		}
+	}
+	
+	//a noiseless axis still keeps the samples one LSB away
+	if(mad == 0){
+		mad = 1;
+	}
+	
+	*sum = 0;
+	*kept = 0;
+	for(int i = 0; i < n; i ++){
+		deviation = values[i * stride] - median;
+		if(deviation < 0){
+			deviation = -deviation;
+		}
+		if(deviation <= ACL2_CALIBRATE_REJECT * mad){
+			*sum = *sum + values[i * stride];
+			*kept = *kept + 1;
+		}
+	}
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  roundMean()
+**
+**  Parameters:
+**    sum - sum of the samples
+**		n - number of samples, more than 0
+**
+**  Return Value:
+**    int - sum / n rounded to the nearest integer
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	rounding division used for the calibration averages
+*/
+int ACL2::roundMean(long sum, int n){
+	
+	if(sum < 0){
+		return -(int)((-sum + n / 2) / n);
+	}
+	return (int)((sum + n / 2) / n);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  getCalibration()
+**
+**  Parameters:
+**    ACL2calibration* out - blob to fill
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	copies the current offsets into a blob that can be written to EEPROM or flash
+**		and given back to setCalibration() after the next begin()
+*/
+void ACL2::getCalibration(ACL2calibration* out){
+	
+	out->version = ACL2_CALIBRATION_VERSION;
+	out->range = range;
+	out->xZero = xZero;
+	out->yZero = yZero;
+	out->zZero = zZero;
+	out->checksum = calibrationChecksum(out);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  setCalibration()
+**
+**  Parameters:
+**    const ACL2calibration* in - blob written by getCalibration()
+**
+**  Return Value:
+**    bool - true if the offsets were loaded
+**
+**  Errors:
+**    returns false and keeps the current offsets if the version or the checksum
+**		does not match, for example when the EEPROM was never written, or if the
+**		offsets were measured at another range than the current one
+**
+**  Description:
+**   	loads offsets saved with getCalibration(), replacing the defaults begin() sets.
+**		Call setRange() first if the blob was saved at another range
+*/
+bool ACL2::setCalibration(const ACL2calibration* in){
+	
+	if(in->version != ACL2_CALIBRATION_VERSION || in->checksum != calibrationChecksum(in)){
+		return false;
+	}
+	
+	//offsets are in mg, but the error they correct scales with the range
+	if(in->range != range){
+		return false;
+	}
+	
+	xZero = in->xZero;
+	yZero = in->yZero;
+	zZero = in->zZero;
+	
+	return true;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  calibrationChecksum()
+**
+**  Parameters:
+**    const ACL2calibration* blob - blob to check
+**
+**  Return Value:
+**    uint16_t - Fletcher-16 sum of every byte before the checksum field
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	checksum stored in the calibration blob. Erased EEPROM (all 0xFF) and
+**		all zero memory both fail it
+*/
+uint16_t ACL2::calibrationChecksum(const ACL2calibration* blob){
+	
+	const uint8_t* bytes = (const uint8_t*)blob;
+	uint16_t sum1 = 0;
+	uint16_t sum2 = 0;
+	
+	for(unsigned int i = 0; i < offsetof(ACL2calibration, checksum); i ++){
+		sum1 = (sum1 + bytes[i]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	
+	return (sum2 << 8) | sum1;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  odrPeriod()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    unsigned long - microseconds between conversions at the ODR in FILTER_CTL
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the ODR field counts up from 12.5Hz, doubling each step
+*/
+unsigned long ACL2::odrPeriod(){
+	
+	return 80000UL >> (readShadow(FILTER_CTL) & 0x07);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  getFIFOentries()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int result: the number of FIFO entries stored in the buffer
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	This function reads the FIFO_ENTRIES registers and returns the value inside
+**		
+*/
+int ACL2::getFIFOentries(){
+	
+	return getData(FIFO_ENTRIES_H, FIFO_ENTRIES_L);		
+
+}
+
+/* ------------------------------------------------------------ */
+/*  initFIFO()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	This function manipulates the FIFO and control registers to start the FIFO buffer in a streaming mode
+**		
+*/
+void ACL2::initFIFO(){
+
+	//set interupt1 pin to data ready
+	setRegister(INTMAP1, 1);
+	
+	//turn on FIFO
+	setRegister(FIFO_CONTROL, 10);
+	setRegister(FIFO_SAMPLES, 255);		//set to 512 values for each
+	
+	//FIFO_CONTROL through INTMAP1 in one transaction
+	commitRegisters();
+	
+	//start sample sets over with the new stream
+	setSize = 3;
+	pendingNext = 0;
+	drainRemaining = 0;
+	draining = false;
+	tempDecimation = 0;
+	resetTiming();
+	resetLoss();
+	lastDrain = micros();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  setWatermark()
+**
+**  Parameters:
+**    int entries: number of FIFO entries that sets the FIFO_WATERMARK status bit (1-511)
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    values outside 1-511 are clamped
+**
+**  Description:
+**   	writes the watermark to FIFO_SAMPLES and its ninth bit to FIFO_CONTROL. The
+**		value is rounded down to a whole number of x, y, z (, t) sets
+*/
+void ACL2::setWatermark(int entries){
+	
+	uint8_t control = 0;
+	
+	if(entries > 511){
+		entries = 511;
+	}
+	entries = entries - (entries % setSize);
+	if(entries < setSize){
+		entries = setSize;
+	}
+	
+	//ninth bit of the watermark lives in FIFO_CONTROL
+	control = readShadow(FIFO_CONTROL);
+	if(entries > 255){
+		control = control | FIFO_AH;
+	}
+	else{
+		control = control & ~FIFO_AH;
+	}
+	
+	setRegister(FIFO_CONTROL, control);
+	setRegister(FIFO_SAMPLES, entries & 0xFF);
+	commitRegisters();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  setTemperatureFIFO()
+**
+**  Parameters:
+**    int decimation: 0 for no temperature, 1 to store temperature in the FIFO with every
+**		sample set, N > 1 for one temperature reading every N sets
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    negative values are treated as 0
+**
+**  Description:
+**   	chooses how temperature reaches tempFIFO (or frame.temp with ACL2_FRAME_STORAGE and
+**		ACL2_FRAME_TEMP). With 1 the ACL2 puts a temperature entry after every x, y, z set,
+**		which costs a quarter of the FIFO. With N > 1 temperature stays out of the FIFO and
+**		the drain starts with a read of TEMP_L and TEMP_H once N sets have been stored since
+**		the last reading, at most once per drain. Frames carry the last reading.
+**		Call after initFIFO(). The FIFO is cleared when the set size changes
+*/
+void ACL2::setTemperatureFIFO(int decimation){
+	
+	uint8_t control = readShadow(FIFO_CONTROL);
+	uint8_t newControl = 0;
+	
+	if(decimation < 0){
+		decimation = 0;
+	}
+	
+	newControl = control & ~FIFO_TEMP;
+	if(decimation == 1){
+		newControl = newControl | FIFO_TEMP;
+	}
+	
+	lock();
+	
+	//the set size changes, drop entries stored with the old one
+	if(newControl != control){
+		setRegister(FIFO_CONTROL, 0);
+		commitRegisters();
+		setRegister(FIFO_CONTROL, newControl);
+		commitRegisters();
+		pendingNext = 0;
+		drainRemaining = 0;
+		draining = false;
+		lastDrain = micros();
+	}
+	
+	setSize = decimation == 1 ? 4 : 3;
+	tempDecimation = decimation;
+	tempCountdown = 0;
+	
+	unlock();
+	
+	//watermark has to stay a whole number of sets
+	setWatermark(readShadow(FIFO_SAMPLES) | ((readShadow(FIFO_CONTROL) & FIFO_AH) ? 0x100 : 0));
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  setDataRate()
+**
+**  Parameters:
+**    uint8_t odr: ODR_12_5, ODR_25, ODR_50, ODR_100, ODR_200 or ODR_400
+**		uint8_t bandwidth: BANDWIDTH_ODR_2 or BANDWIDTH_ODR_4 for the anti-aliasing filter
+**		uint8_t noise: NOISE_NORMAL, NOISE_LOW or NOISE_ULTRALOW
+**
+**  Return Value:
+**    int - headroom in percent as reported by checkThroughput(), negative if the
+**		drains cannot keep up at the new rate
+**
+**  Errors:
+**    odr values above ODR_400 are treated as ODR_400
+**
+**  Description:
+**   	sets the output data rate, filter bandwidth and noise mode together. Lower noise
+**		modes draw more current, NOISE_NORMAL with a low ODR draws the least. The ACL2 is
+**		put in standby while FILTER_CTL changes and FILTER_CTL and POWER_CTL are then
+**		written in one transaction. The settings are kept for reset(). The range is kept
+*/
+int ACL2::setDataRate(uint8_t odr, uint8_t bandwidth, uint8_t noise){
+	
+	ACL2throughput report;
+	uint8_t power = 0;
+	
+	if(odr > ODR_400){
+		odr = ODR_400;
+	}
+	
+	filterConfig = (readShadow(FILTER_CTL) & 0xC0) | (bandwidth & BANDWIDTH_ODR_4) | odr;
+	powerConfig = (powerConfig & ~0x30) | (noise & 0x30);
+	power = (readShadow(POWER_CTL) & ~0x30) | (noise & 0x30);
+	
+	lock();
+	
+	//filter changes are made in standby
+	setRegister(POWER_CTL, power & ~0x03);
+	commitRegisters();
+	setRegister(FILTER_CTL, filterConfig);
+	setRegister(POWER_CTL, power);
+	commitRegisters();
+	
+	//the period the timestamps follow has changed
+	resetTiming();
+	
+	unlock();
+	
+	return checkThroughput(&report);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  setSPIClock()
+**
+**  Parameters:
+**    uint32_t hz: SPI clock the bus runs at
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	tells checkThroughput() what the clock is; ACL2_SPI_CLOCK is assumed otherwise.
+**		The transport begin(CS) set up starts its transactions at this clock; where the
+**		core has no SPI transactions the clock set up by the sketch is used as it is
+*/
+void ACL2::setSPIClock(uint32_t hz){
+	
+	if(hz > 0){
+		spiClock = hz;
+#if ACL2_ARDUINO_SPI
+		arduinoBus.setClock(hz);
+#endif
+	}
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  checkThroughput()
+**
+**  Parameters:
+**    ACL2throughput* out: structure to fill in
+**
+**  Return Value:
+**    int - percent of the time between drains left after the bus time of one drain,
+**		negative if the FIFO would overrun
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	estimates whether the current drain strategy keeps up with the ODR. With
+**		beginInterrupt() a drain reads the watermark worth of entries and must finish
+**		before the FIFO collects that many again and before the rest of the FIFO fills.
+**		When polling, fillFIFO() must be called before the FIFO fills, so a drain reads
+**		the whole FIFO. Only bus time at the setSPIClock() clock and ACL2_TRANSACTION_US
+**		per transaction are counted; the time to store the frames is not
+*/
+int ACL2::checkThroughput(ACL2throughput* out){
+	
+	uint32_t period = odrPeriod();
+	uint32_t limit = 0;
+	uint32_t bytes = 0;
+	uint32_t transactions = 0;
+	int entries = 0;
+	int chunks = 0;
+	
+	if(interrupt >= 0){
+		entries = readShadow(FIFO_SAMPLES) | ((readShadow(FIFO_CONTROL) & FIFO_AH) ? 0x100 : 0);
+	}
+	else{
+		entries = 512 - (512 % setSize);
+	}
+	
+	//STATUS and FIFO_ENTRIES come in one 3 byte burst, then the entries in ACL2_DRAIN_CHUNK blocks
+	chunks = (entries + ACL2_DRAIN_CHUNK - 1) / ACL2_DRAIN_CHUNK;
+	bytes = 5 + chunks + 2 * entries;
+	transactions = 1 + chunks;
+	if(tempDecimation > 1){
+		bytes = bytes + 4;
+		transactions = transactions + 1;
+	}
+	
+	out->entries = entries;
+	out->drainUs = bytes * 8000 / (spiClock / 1000) + transactions * ACL2_TRANSACTION_US;
+	out->intervalUs = (entries / setSize) * period;
+	out->marginUs = 0;
+	
+	limit = out->intervalUs;
+	if(interrupt >= 0){
+		out->marginUs = ((512 - entries) / setSize) * period;
+		if(out->marginUs < limit){
+			limit = out->marginUs;
+		}
+	}
+	
+	if(limit == 0){
+		out->headroom = -100;
+	}
+	else{
+		out->headroom = (int)(((long)limit - (long)out->drainUs) * 100 / (long)limit);
+	}
+	
+	return out->headroom;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  getOverflowTime()
+**
+**  Parameters:
+**    int entries: FIFO level, e.g. from getFIFOentries()
+**
+**  Return Value:
+**    unsigned long - microseconds until a FIFO holding entries overruns at the
+**		current ODR, 0 if it is already full
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the FIFO takes setSize entries per conversion period, so only whole sample
+**		sets of free space count
+*/
+unsigned long ACL2::getOverflowTime(int entries){
+	
+	if(entries >= 512){
+		return 0;
+	}
+	
+	return ((512 - entries) / setSize) * odrPeriod();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  beginInterrupt()
+**
+**  Parameters:
+**    uint8_t interruptNumber: the external interrupt (as given to attachInterrupt())
+**		that the ACL2 interrupt pin is wired to
+**		uint8_t intPin: 1 to use the ACL2 INT1 pin, 2 to use INT2
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    does nothing if interruptNumber is ACL2_MAX_INTERRUPTS or more
+**
+**  Description:
+**   	maps FIFO_WATERMARK to the chosen ACL2 pin and attaches an interrupt that drains
+**		the FIFO into xFIFO, yFIFO and zFIFO every time the watermark set by setWatermark()
+**		is reached. Call after initFIFO(). A watermark that arrives while the library
+**		is using the bus is drained as soon as the transaction ends. The interrupt is
+**		registered with the transport, so with ACL2arduinoSPI a watermark during another
+**		library's SPI transaction waits for that transaction to end
+*/
+void ACL2::beginInterrupt(uint8_t interruptNumber, uint8_t intPin){
+	
+	if(interruptNumber >= ACL2_MAX_INTERRUPTS){
+		return;
+	}
+	
+	endInterrupt();
+	
+	//route the watermark to the chosen pin only
+	if(intPin == 2){
+		writeRegister(INTMAP2, STATUS_FIFO_WATERMARK);
+	}
+	else{
+		writeRegister(INTMAP1, STATUS_FIFO_WATERMARK);
+	}
+	
+	interrupt = interruptNumber;
+	interruptOwner[interrupt] = this;
+	//other drivers' transactions on the bus hold the drain off until they end
+	bus->usingInterrupt(interrupt);
+	attachInterrupt(interrupt, interruptHandler[interrupt], RISING);
+	
+	//the pin only rises again once the FIFO is below the watermark
+	fillFIFO();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  endInterrupt()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	detaches the FIFO interrupt set up by beginInterrupt()
+*/
+void ACL2::endInterrupt(){
+	
+	if(interrupt >= 0){
+		detachInterrupt(interrupt);
+		bus->notUsingInterrupt(interrupt);
+		interruptOwner[interrupt] = 0;
+		interrupt = -1;
+	}
+	drainPending = false;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  serviceInterrupt()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	interrupt handler body. Drains the FIFO right away, or defers the drain until
+**		the current transaction ends if the bus is in use. Can also be called from a
+**		user interrupt handler
+*/
+void ACL2::serviceInterrupt(){
+	
+	if(lockDepth != 0){
+		drainPending = true;
+		return;
+	}
+	
+	fillFIFO();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  fillFIFO()
+**
+**  Parameters:
+**	   none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	This function initiates the FIFO read then reads and processes the data
+**		coming out of the FIFO buffer and places them into their respective myQueue
+*/
+void ACL2::fillFIFO(){		
+	
+	lock();
+	drainFIFO();
+	unlock();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  fillFIFO()
+**
+**  Parameters:
+**	   const uint8_t* status: STATUS, FIFO_ENTRIES_L and FIFO_ENTRIES_H as read by
+**			readRegisters(STATUS, status, 3)
+**		uint32_t when: micros() right after that read
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    no drain may run between the read and this call, or entries it already took
+**		would be read again
+**
+**  Description:
+**   	drains the entries counted in status without reading STATUS and FIFO_ENTRIES a
+**		second time, for a scheduler such as ACL2bus that has read them to decide when
+**		to drain. Overruns and timestamps are worked out as of when; entries that
+**		arrived since are left for the next drain
+*/
+void ACL2::fillFIFO(const uint8_t* status, uint32_t when){
+	
+	lock();
+	drainFIFO(status, when);
+	unlock();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  startDrain()
+**
+**  Parameters:
+**	   none
+**
+**  Return Value:
+**    int - FIFO entries the drain will read, 0 if there was nothing to read
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	starts a drain that pollDrain() moves along a chunk at a time, so loop() is
+**		never held for more than one chunk. Reads STATUS and FIFO_ENTRIES now; entries
+**		that arrive later are left for the next drain. Returns the entries still to
+**		read if a drain is already under way
+*/
+int ACL2::startDrain(){
+	
+	if(draining){
+		return drainRemaining;
+	}
+	
+	lock();
+	beginDrain();
+	if(drainRemaining == 0){
+		endDrain();
+	}
+	unlock();
+	
+	return drainRemaining;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  pollDrain()
+**
+**  Parameters:
+**	   int maxEntries: most entries to read in this call, at most ACL2_DRAIN_CHUNK
+**
+**  Return Value:
+**    int - entries the drain still has to read, 0 once it is complete
+**
+**  Errors:
+**    returns 0 if no drain was started
+**
+**  Description:
+**   	reads and stores the next chunk of a drain begun by startDrain() in one
+**		transaction. The bus time of a call is bounded by maxEntries, two bytes
+**		each, so the latency it adds to loop() can be chosen. A FIFO interrupt or
+**		fillFIFO() between calls finishes the drain in one go
+*/
+int ACL2::pollDrain(int maxEntries){
+	
+	if(!draining){
+		return 0;
+	}
+	
+	if(maxEntries > ACL2_DRAIN_CHUNK){
+		maxEntries = ACL2_DRAIN_CHUNK;
+	}
+	if(maxEntries < 1){
+		maxEntries = 1;
+	}
+	
+	lock();
+	//an interrupt drain may have finished it while the bus was free
+	if(draining){
+		drainChunk(maxEntries);
+		if(drainRemaining == 0){
+			endDrain();
+		}
+	}
+	unlock();
+	
+	return drainRemaining;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  isDraining()
+**
+**  Parameters:
+**	   none
+**
+**  Return Value:
+**    bool - true between startDrain() and the pollDrain() call that completes it
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+bool ACL2::isDraining(){
+	
+	return draining;
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  setCapture()
+**
+**  Parameters:
+**	   ACL2capture* capture: buffers to store sample sets in, 0 to go back to the queues
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	sends every set from later drains to the capture's back buffer as an
+**		ACL2frame, with temperature, time and set number as enabled for frameFIFO.
+**		The queues are left as they are
+*/
+void ACL2::setCapture(ACL2capture* capture){
+	
+	lock();
+	this->capture = capture;
+	unlock();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  drainFIFO()
+**
+**  Parameters:
+**	   const uint8_t* status: STATUS and FIFO_ENTRIES already read, 0 to read them now
+**		uint32_t when: micros() when status was read
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	body of fillFIFO(), run with the bus locked either from fillFIFO() or from
+**		the FIFO interrupt. Only complete sample sets are stored; a set cut off at
+**		the end of the drain is finished by the next one. A drain left part way by
+**		pollDrain() is closed and its entries read with the rest
+*/
+void ACL2::drainFIFO(const uint8_t* status, uint32_t when){		
+	
+	if(draining){
+		endDrain();
+	}
+	
+	if(status != 0){
+		beginDrain(status, when);
+	}
+	else{
+		beginDrain();
+	}
+	while(drainRemaining > 0){
+		drainChunk(ACL2_DRAIN_CHUNK);
+	}
+	endDrain();
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  beginDrain()
+**
+**  Parameters:
+**	   none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	first step of a drain. STATUS is read with the entry count so overruns since
+**		the last drain are counted, and the count sets drainRemaining
+*/
+void ACL2::beginDrain(){
+	
+	uint8_t status[3];
+#if ACL2_STATS
+	uint32_t start = micros();
+#endif
+	
+	//STATUS and FIFO_ENTRIES in one transaction, reading STATUS clears FIFO_OVERRUN
+	readRegisters(STATUS, status, 3);
+	beginDrain(status, micros());
+	
+#if ACL2_STATS
+	drainBusy = micros() - start;
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  beginDrain()
+**
+**  Parameters:
+**	   const uint8_t* status: STATUS, FIFO_ENTRIES_L and FIFO_ENTRIES_H
+**		uint32_t now: micros() right after they were read
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	starts a drain of the entries counted in status
+*/
+void ACL2::beginDrain(const uint8_t* status, uint32_t now){
+	
+	int samples = ((status[2] & 0x03) << 8) | status[1];
+#if ACL2_STATS
+	uint32_t start = micros();
+	
+	drainStored = stats.frames;
+#endif
+	
+	//decimated temperature, one register read for the whole drain so its frames carry it
+	if(tempDecimation > 1 && tempCountdown == 0){
+		readTemperature();
+		tempCountdown = tempDecimation;
+	}
+	
+	if(status[0] & STATUS_FIFO_OVERRUN){
+		countOverrun(now, samples);
+	}
+	lastDrain = now;
+	
+#if ACL2_STATS
+	if(samples > stats.maxEntries){
+		stats.maxEntries = samples;
+	}
+#endif
+	
+#if ACL2_FRAME_TIME
+	//newest set counted above was converted just before now
+	updateTiming(now, (pendingNext + samples) / setSize);
+#endif
+	
+	drainRemaining = samples;
+	draining = true;
+	
+#if ACL2_STATS
+	drainBusy = micros() - start;
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  drainChunk()
+**
+**  Parameters:
+**	   int maxEntries: most entries to read, at most ACL2_DRAIN_CHUNK
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reads up to maxEntries of the drain in one block transfer and stores them
+*/
+void ACL2::drainChunk(int maxEntries){
+	
+	uint16_t buffer = 0;
+	int result = 0;	
+	char dir = '\0';
+	int count = 0;
+	int i = 0;
+	uint8_t raw[ACL2_DRAIN_CHUNK * 2];
+#if ACL2_STATS
+	uint32_t start = micros();
+#endif
+	
+	//pull up to a chunk of raw entries off the FIFO in one block transfer
+	count = drainRemaining < maxEntries ? drainRemaining : maxEntries;
+	readFIFO(raw, count);
+	drainRemaining = drainRemaining - count;
+	
+	//decode the chunk once chip select is released
+	while(i < count){		
+		//8 LSBs come first, then the 8 MSBs
+		buffer = (raw[2 * i + 1] << 8) | raw[2 * i];
+		
+		//receive axis of data
+		dir = getDIR(buffer);
+		
+		//full 12 bit sample, sign extended from bit 13
+		result = ACL2entryValue(buffer);
+		
+		//scales data, temperature is left as it is
+		if(dir != 't'){
+			result *= scale;
+		}
+		
+		//line the entry up with the rest of its sample set
+		alignEntry(dir, result);
+				
+		//increment counter
+		i = i + 1;
+	}
+	
+#if ACL2_STATS
+	drainBusy += micros() - start;
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  endDrain()
+**
+**  Parameters:
+**	   none
 **
 **  Return Value:
-**    int result - an integer value of the combined data in the two registers
+**    none
 **
 **  Errors:
 **    none
 **
 **  Description:
-**   	get Data is used to get the 11 bit x,y,z and temp values that come from 2 registers
-**		from the accelerometer. The function spits out a signed integer value
+**   	closes a drain and counts the sets it stored and the time it held the bus.
+**		The time of a drain spread over several pollDrain() calls leaves out the
+**		gaps between them
 */
-int ACL2::getData(uint8_t reg1, uint8_t reg2){
+void ACL2::endDrain(){
 	
-	//create variable to be returned
-	uint16_t buffer = 0;
-	int result = 0;	
-	int sign = 0;
+	drainRemaining = 0;
+	draining = false;
 	
-	//store XData high into result
-	buffer = readRegister(reg1);
+#if ACL2_STATS
+	//sets and time this drain took
+	stats.drains ++;
+	drainStored = stats.frames - drainStored;
+	if(drainStored > stats.maxFrames){
+		stats.maxFrames = drainStored;
+	}
+	stats.drainUsTotal += drainBusy;
+	if(drainBusy < stats.drainUsMin){
+		stats.drainUsMin = drainBusy;
+	}
+	if(drainBusy > stats.drainUsMax){
+		stats.drainUsMax = drainBusy;
+	}
+#endif
 	
-	//Shift over 8 to make room for lower bits
-	buffer = buffer << 8;
+}
 
-	//store XData low into 8 LSB
-	buffer = readRegister(reg2) | buffer;
+/* ------------------------------------------------------------ */
+/*  resetTiming()
+**
+**  Parameters:
+**	   none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	restarts the set counter and, with ACL2_FRAME_TIME, the timestamp estimator at the
+**		nominal period of the ODR in FILTER_CTL. The next drain sets the phase
+*/
+void ACL2::resetTiming(){
+	
+	frameSeq = 0;
+#if ACL2_FRAME_TIME
+	timeValid = false;
+	framePeriod = odrPeriod() << 8;
+	nextTime = 0;
+	nextFrac = 0;
+	anchorTime = 0;
+	anchorSeq = 0;
+	midTime = 0;
+	midSeq = 0;
+#endif
+	
+}
+
+#if ACL2_FRAME_TIME
+/* ------------------------------------------------------------ */
+/*  updateTiming()
+**
+**  Parameters:
+**	   uint32_t now - micros() right after FIFO_ENTRIES was read
+**		int frames - sets that will be completed by this drain
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    an error of more than four periods (a restarted FIFO, or sets lost to an overrun)
+**		restarts the phase from this drain
+**
+**  Description:
+**   	the timestamps follow a line of one set per estimated period. The newest set in
+**		the FIFO must have been converted within the period before now, so each drain
+**		bounds the line from both sides and the line is only moved when it leaves those
+**		bounds. The period is measured along the line between an anchor point and the
+**		newest set, which averages over up to ACL2_DRIFT_WINDOW sets and follows the
+**		sensor oscillator instead of the nominal ODR. Once the window is full the anchor
+**		moves to the point that was recorded half way along it
+*/
+void ACL2::updateTiming(uint32_t now, int frames){
+	
+	uint32_t predicted = 0;
+	uint32_t newest = 0;
+	uint32_t span = 0;
+	uint32_t elapsed = 0;
+	uint32_t period = framePeriod >> 8;
+	int32_t error = 0;
 	
-	if(buffer >= 0x8000){// If negative
-		sign = 1;
-		buffer = twosToBin(buffer);
+	if(frames <= 0){
+		return;
 	}
 	
-	//Get rid of first 4 bits
-	result = buffer & 0x07ff;
-
-	if(sign == 1){
-		result = 0 - result;
+	newest = frameSeq + frames - 1;
+	predicted = nextTime + (((uint32_t)(frames - 1) * framePeriod + nextFrac) >> 8);
+	
+	//first drain, the newest set is on average half a period old
+	if(!timeValid){
+		predicted = now - period / 2;
+		nextTime = predicted - (((uint32_t)(frames - 1) * framePeriod) >> 8);
+		nextFrac = 0;
+		anchorTime = predicted;
+		anchorSeq = newest;
+		midSeq = newest;
+		timeValid = true;
+		return;
 	}
 	
-	return result;	
+	//the newest set was converted during the period before the read. The line only
+	//moves when it falls outside that window, so drain jitter does not reach the stamps
+	error = (int32_t)(now - predicted);
+	if(error > (int32_t)(4 * period) || error < -(int32_t)(4 * period)){
+		//lost track, restart in the middle of the window
+		error = error - (int32_t)(period / 2);
+	}
+	else if(error >= (int32_t)period){
+		error = error - (int32_t)period + 1;
+	}
+	else if(error > 0){
+		error = 0;
+	}
+	nextTime = nextTime + error;
+	predicted = predicted + error;
+	
+	//period from the anchor to the newest set, split to stay inside 32 bits
+	span = newest - anchorSeq;
+	if(span >= ACL2_DRIFT_WINDOW / 64){
+		elapsed = predicted - anchorTime;
+		framePeriod = ((elapsed / span) << 8) + (((elapsed % span) << 8) / span);
+	}
+	
+	//slide the window, the point half way along becomes the anchor
+	if(span >= ACL2_DRIFT_WINDOW / 2 && midSeq == anchorSeq){
+		midTime = predicted;
+		midSeq = newest;
+	}
+	if(span >= ACL2_DRIFT_WINDOW){
+		anchorTime = midTime;
+		anchorSeq = midSeq;
+	}
+	
+}
 
+/* ------------------------------------------------------------ */
+/*  getSamplePeriod()
+**
+**  Parameters:
+**	   none
+**
+**  Return Value:
+**    uint32_t - estimated time between sample sets in ns
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the period used for the timestamps, measured against micros()
+*/
+uint32_t ACL2::getSamplePeriod(){
+	
+	return (framePeriod >> 8) * 1000 + (((framePeriod & 0xFF) * 1000) >> 8);
+	
 }
 
 /* ------------------------------------------------------------ */
-/*  twosToBin()
+/*  getDrift()
 **
 **  Parameters:
-**    input - an 11 bit twos complement value to be converted to a binary number
+**	   none
 **
 **  Return Value:
-**    returns a 16 bit unsigned integer with the positive value of the negative twos compliment
+**    long - difference between the estimated and the nominal period in ppm, positive
+**		when the ACL2 runs slow against micros()
 **
 **  Errors:
 **    none
 **
 **  Description:
-**   	This function converts a negative twos compliment value and preforms a bitwise flip and subtracts
-**		one to return the positive int value.
+**   	oscillator tolerance of the ACL2 relative to the MCU clock
 */
-uint16_t ACL2::twosToBin(uint16_t input){	
+long ACL2::getDrift(){
 	
-	//flip all 11 bits
-	input = input ^ 0x07ff;
+	uint32_t nominal = odrPeriod() << 8;
 	
-	//subtract 1 to get binary
-	input = input - 1;
+	return (long)(((long long)framePeriod - nominal) * 1000000 / nominal);
 	
-	return input;	
 }
+#endif
 
 /* ------------------------------------------------------------ */
-/*  getDIR()
+/*  readTemperature()
 **
 **  Parameters:
-**    uint16_t value: FIFO raw data to parse direction from
+**	   none
 **
 **  Return Value:
-**    char result: axis that the FIFO data represents
+**    none
 **
 **  Errors:
-**    does not handle temperature FIFO data
+**    none
 **
 **  Description:
-**   	This function takes the raw FIFO data and analyses the 2 MSBs to determine
-**		the axis the data represents
+**   	reads TEMP_L and TEMP_H in one transaction for the decimated temperature channel,
+**		storing the value in tempFIFO, or holding it for the next frames with ACL2_FRAME_STORAGE
+**		or while a capture is attached, so tempFIFO does not fill up behind the capture
 */
-char ACL2::getDIR(uint16_t value){
-	char result = '\0';	
+void ACL2::readTemperature(){
 	
-	//only care about first 2 bits
-	value = value >> 14;
+	uint8_t data[2];
 	
-	if(value  == 0)
-		result = 'x';
-	if(value == 1)
-		result = 'y';
-	if(value ==  2)
-		result = 'z';
-	if(value == 3)
-		result = 't';
+	readRegisters(TEMP_L, data, 2);
+	heldTemp = decodeData((data[1] << 8) | data[0]);
 	
-	return result;	
+#if !ACL2_FRAME_STORAGE
+	if(capture == 0){
+		tempFIFO.push_back(heldTemp);
+	}
+#endif
+	
+}
 
+/* ------------------------------------------------------------ */
+/*  alignEntry()
+**
+**  Parameters:
+**    char dir - axis of the entry as returned by getDIR()
+**		int value - scaled entry value
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    an entry that arrives out of x, y, z (, t) order discards the partial set
+**		it would have joined, and storage restarts at the next x entry
+**
+**  Description:
+**   	collects FIFO entries into the partial set held in pending[] and stores the
+**		set with storeFrame() once it is complete. The partial set is kept in the object,
+**		so sets split across drains still come out whole
+*/
+void ACL2::alignEntry(char dir, int value){
+	
+	uint8_t axis = 0;
+	
+	if(dir == 'y'){
+		axis = 1;
+	}
+	else if(dir == 'z'){
+		axis = 2;
+	}
+	else if(dir == 't'){
+		axis = 3;
+	}
+	
+	//out of sequence, drop the partial set and wait for the next x
+	if(axis != pendingNext){
+		pendingNext = 0;
+		if(axis != 0){
+			return;
+		}
+	}
+	
+	pending[axis] = value;
+	pendingNext = pendingNext + 1;
+	
+	if(pendingNext == setSize){
+		storeFrame();
+		pendingNext = 0;
+	}
+	
 }
 
 /* ------------------------------------------------------------ */
-/* 	myQueue()
+/*  storeFrame()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    none
 **
 **  Return Value:
 **    none
@@ -801,19 +2623,76 @@ char ACL2::getDIR(uint16_t value){
 **    none
 **
 **  Description:
-**    Constructor for queue sets the pointers to initial positions
-**		and clears the queue by calling resetQueue()
+**   	applies the zero offsets to the complete set in pending[] and stores it in
+**		frameFIFO, or in xFIFO, yFIFO, zFIFO and tempFIFO. A set that does not fit
+**		is counted in getLoss() instead
 */
-myQueue::myQueue(){		
-	resetQueue();
-	return;
+void ACL2::storeFrame(){
+	
+	ACL2frame frame;
+	bool full = capture != 0 ? capture->isFull() : queuesFull();
+	
+	//drop the whole set so the queues stay the same length
+	if(full){
+		loss.queueOverflows = loss.queueOverflows + 1;
+		if(capture != 0){
+			capture->dropped ++;
+		}
+		if(!dropping){
+			loss.lastGapFrames = 0;
+		}
+		loss.lastGapFrames = loss.lastGapFrames + 1;
+		loss.lastGapSeq = frameSeq + 1;
+		dropping = true;
+	}
+	else{
+		if(capture != 0){
+			makeFrame(&frame);
+			capture->store(&frame);
+		}
+		else{
+#if ACL2_FRAME_STORAGE
+			makeFrame(&frame);
+			frameFIFO.push_back(frame);
+#else
+			xFIFO.push_back(pending[0] + xZero);
+			yFIFO.push_back(pending[1] + yZero);
+			zFIFO.push_back(pending[2] + zZero);
+			if(setSize == 4){
+				tempFIFO.push_back(pending[3]);
+			}
+#if ACL2_FRAME_TIME
+			timeFIFO.push_back(nextTime);
+#endif
+#if ACL2_FRAME_SEQ
+			seqFIFO.push_back(frameSeq);
+#endif
+#endif
+		}
+		dropping = false;
+#if ACL2_STATS
+		stats.frames ++;
+#endif
+	}
+	
+	frameSeq = frameSeq + 1;
+#if ACL2_FRAME_TIME
+	//step to the next set, carrying the fraction of a microsecond
+	nextTime = nextTime + (framePeriod >> 8) + ((nextFrac + (framePeriod & 0xFF)) >> 8);
+	nextFrac = nextFrac + (framePeriod & 0xFF);
+#endif
+	
+	if(tempCountdown > 0){
+		tempCountdown = tempCountdown - 1;
+	}
+	
 }
 
 /* ------------------------------------------------------------ */
-/* 	empty()
+/*  makeFrame()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    frame - structure to fill in
 **
 **  Return Value:
 **    none
@@ -822,87 +2701,180 @@ myQueue::myQueue(){
 **    none
 **
 **  Description:
-**    sets all members of the queue to -1
-**	   resets the pointers to the beginning
+**   	builds the frame for the set in pending[], with the zero offsets applied
+*/
+void ACL2::makeFrame(ACL2frame* frame){
+	
+	frame->x = pending[0] + xZero;
+	frame->y = pending[1] + yZero;
+	frame->z = pending[2] + zZero;
+#if ACL2_FRAME_TEMP
+	frame->temp = setSize == 4 ? pending[3] : heldTemp;
+#endif
+#if ACL2_FRAME_TIME
+	frame->time = nextTime;
+#endif
+#if ACL2_FRAME_SEQ
+	frame->seq = frameSeq;
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  queuesFull()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    bool - true if any queue the next set goes to is full
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	checked before a set is stored, so a set is stored in every queue or in none
+*/
+bool ACL2::queuesFull(){
+	
+#if ACL2_FRAME_STORAGE
+	return frameFIFO.size() >= frameFIFO.capacity();
+#else
+	bool full = xFIFO.size() >= xFIFO.capacity() || yFIFO.size() >= yFIFO.capacity() ||
+		zFIFO.size() >= zFIFO.capacity();
+	
+	if(setSize == 4){
+		full = full || tempFIFO.size() >= tempFIFO.capacity();
+	}
+#if ACL2_FRAME_TIME
+	full = full || timeFIFO.size() >= timeFIFO.capacity();
+#endif
+#if ACL2_FRAME_SEQ
+	full = full || seqFIFO.size() >= seqFIFO.capacity();
+#endif
+	return full;
+#endif
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  countOverrun()
+**
+**  Parameters:
+**    uint32_t now - micros() when FIFO_ENTRIES was read
+**		int entries - entries in the FIFO
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    the estimate is good to about one set; the drain before must have emptied the FIFO
+**
+**  Description:
+**   	called when STATUS shows the FIFO overran since the last drain. The sets converted
+**		since then, from the elapsed time and the sample period, less the sets still in
+**		the FIFO, are the sets the ACL2 threw away. The set numbers skip over them so the
+**		gap shows in frame.seq, seqFIFO and the timestamps
 */
-void myQueue::empty(){
+void ACL2::countOverrun(uint32_t now, int entries){
+	
+#if ACL2_FRAME_TIME
+	uint32_t period = framePeriod >> 8;
+#else
+	uint32_t period = odrPeriod();
+#endif
+	uint32_t converted = (now - lastDrain + period / 2) / period;
+	uint32_t held = (pendingNext + entries) / setSize;
+	uint32_t lost = converted > held ? converted - held : 0;
 	
-	//traverse through queue and set to -1
-	for(int i = 0; i < 512; i ++){
-		dataQueue[i] = -999999;
-	}		
+	loss.overruns = loss.overruns + 1;
+	loss.lostFrames = loss.lostFrames + lost;
+	
+	frameSeq = frameSeq + lost;
+#if ACL2_FRAME_TIME
+	nextTime = nextTime + lost * (framePeriod >> 8) + ((lost * (framePeriod & 0xFF)) >> 8);
+#endif
+	
+	loss.lastGapSeq = frameSeq;
+	loss.lastGapFrames = lost;
 	
-	//set ptrs to the beginning
-	tail_ptr = 0;
-	head_ptr = 0;
-	return;
 }
 
 /* ------------------------------------------------------------ */
-/* 	size()
+/*  getLoss()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    ACL2loss* out - structure to copy the counters to
 **
 **  Return Value:
-**    int size: number of items in the queue
+**    none
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    returns the location of the tail_ptr which equals number of items
-**		
+**   	reports data lost since initFIFO() or resetLoss(): overruns of the ACL2 FIFO with
+**		an estimate of the sets they cost, and sets dropped because the queues were full.
+**		An overrun is only seen by the drain if nothing else read STATUS in between
 */
-int myQueue::size(){
-	return tail_ptr;
+void ACL2::getLoss(ACL2loss* out){
+	
+	*out = loss;
+	
 }
 
 /* ------------------------------------------------------------ */
-/* 	front()
+/*  resetLoss()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    none
 **
 **  Return Value:
-**    int front: the value in the front of the queue
+**    none
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    returns the first item in the queue
-**		
+**   	clears the lost data counters
 */
-int myQueue::front(){
-	return dataQueue[head_ptr];
+void ACL2::resetLoss(){
+	
+	loss.overruns = 0;
+	loss.lostFrames = 0;
+	loss.queueOverflows = 0;
+	loss.lastGapSeq = 0;
+	loss.lastGapFrames = 0;
+	
 }
 
 /* ------------------------------------------------------------ */
-/* 	back()
+/*  getFrameSeq()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    none
 **
 **  Return Value:
-**    int back: the last item in the queue
+**    uint32_t - number the next stored set will get
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    returns the last item in the queue
-**		
+**   	sets are numbered from 0 at initFIFO(), lost sets included
 */
-int myQueue::back(){
-	return dataQueue[tail_ptr - 1];
+uint32_t ACL2::getFrameSeq(){
+	
+	return frameSeq;
+	
 }
 
 /* ------------------------------------------------------------ */
-/* 	push_back()
+/*  readFIFO()
 **
-**  Parameters: 
-**		int value: item to be pushed onto the back of the queue
+**  Parameters:
+**    uint8_t* raw - buffer of at least 2 * entries bytes to store the raw entries
+**		int entries - number of FIFO entries to read
 **
 **  Return Value:
 **    none
@@ -911,108 +2883,113 @@ int myQueue::back(){
 **    none
 **
 **  Description:
-**    accepts a value then pushes it onto the back of the queue
-**	
+**   	sends FIFO_READ and clocks the requested entries out in a single block
+**		transfer. Each entry is two bytes, low byte first. Chip select is only held
+**		low for the transfer itself
 */
-void myQueue::push_back(int value){
-		dataQueue[tail_ptr] = value;
-		if (tail_ptr != back_ptr){
-			tail_ptr = tail_ptr + 1;
-		}
-		return;
+void ACL2::readFIFO(uint8_t* raw, int entries){
+	
+	uint8_t command = FIFO_READ;
+	
+	//the bytes sent while reading the FIFO are don't care
+	select();
+	transfer(&command, 0, 1);
+	transfer(0, raw, entries * 2);
+	deselect();
+	
 }
 
 /* ------------------------------------------------------------ */
-/* 	pop_front()
+/*  getData()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    	reg1 - first register to read from. the high data value which contains 
+**		the 3 MSBs
+**		reg2 - second register to read from. the low data value which contains
+**		the 8 LSBs
 **
 **  Return Value:
-**    int front: item that is popped off front of the queue
+**    int result - an integer value of the combined data in the two registers
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Takes the item first in the queue and returns it then 
-**    moves the head_ptr to the next item in the queue
-**		
+**   	get Data is used to get the 12 bit x,y,z and temp values that come from 2 registers
+**		from the accelerometer. The function spits out a signed integer value
 */
-int myQueue::pop_front(){
+int ACL2::getData(uint8_t reg1, uint8_t reg2){
 	
-	//store front value to return
-	int result = dataQueue[head_ptr];
+	//create variable to be returned
+	uint16_t buffer = 0;
 	
-	//if queue not empty, move head ptr back one over
-	//new first item
-	if(tail_ptr > head_ptr){
-		head_ptr = head_ptr + 1;	
-	}
-	//if the queue is empty reset pointers to start again
+	//store XData high into result
+	buffer = readRegister(reg1);
 	
+	//Shift over 8 to make room for lower bits
+	buffer = buffer << 8;
 
-	else{
-		//Serial.println("The queue is empty");
-		resetQueue();
-		return 0;
-	}	
+	//store XData low into 8 LSB
+	buffer = readRegister(reg2) | buffer;
 	
-	return result;
+	return decodeData(buffer);	
+
 }
 
 /* ------------------------------------------------------------ */
-/* 	resetQueue()
+/*  decodeData()
 **
-**  Parameters: 
-**		none
+**  Parameters:
+**    buffer - the combined high and low data register values
 **
 **  Return Value:
-**    none
+**    int result - the signed value held in the registers
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    sets pointer values to start over queue then empties it by calling empty()
-**	
+**   	converts the 16 bit register pair used for the x,y,z and temp values into a
+**		signed integer at full 12 bit resolution. Shared by getData() and getXYZT()
 */
-void myQueue::resetQueue(void)
-{
-	//initialize pointers
-	back_ptr = 511;
-	front_ptr = 0;
-	tail_ptr = 0;
-	head_ptr = 0;
+int ACL2::decodeData(uint16_t buffer){
 	
-	//clear queue
-	empty();
-	return;
+	//the registers hold 12 bit data already sign extended to 16 bits
+	return (int16_t)buffer;	
+
 }
 
 /* ------------------------------------------------------------ */
-/* 	getQueue()
+/*  getDIR()
 **
-**  Parameters: 
-**		int* outQueue	an integer array to copy data to
+**  Parameters:
+**    uint16_t value: FIFO raw data to parse direction from
 **
 **  Return Value:
-**    none
+**    char result: axis that the FIFO data represents
 **
 **  Errors:
-**    none
+**    does not handle temperature FIFO data
 **
 **  Description:
-**    accepts an integer array pointer then empties the dataQueue into the array. 
-**	
+**   	This function takes the raw FIFO data and analyses the 2 MSBs to determine
+**		the axis the data represents
 */
-void  myQueue::getQueue(int* outqueue){
+char ACL2::getDIR(uint16_t value){
+	char result = '\0';	
 	
-	//traverse queue and print and pop
-	for(int i = 0; i < (size()); i ++){
-		outqueue[i]=pop_front();
-	}
-	resetQueue();
+	//only care about first 2 bits
+	value = value >> 14;
+	
+	if(value  == 0)
+		result = 'x';
+	if(value == 1)
+		result = 'y';
+	if(value ==  2)
+		result = 'z';
+	if(value == 3)
+		result = 't';
 	
-	return;
+	return result;	
+
 }
@@ -36,7 +36,89 @@
 #if !defined(ACL2_H)
 #define ACL2_H
 
-#include "SPI.h"
+//set to 0 to compile out the bus and drain counters behind getStats()
+#if !defined(ACL2_STATS)
+#define ACL2_STATS 1
+#endif
+
+//set to 1 to store drained FIFO data as packed ACL2frame records in frameFIFO
+//instead of the int xFIFO, yFIFO, zFIFO and tempFIFO queues (about 1.5KB
+//instead of 8KB by default). These options must be set here or with a
+//compiler flag; a #define in the sketch does not reach ACL2.cpp
+#if !defined(ACL2_FRAME_STORAGE)
+#define ACL2_FRAME_STORAGE 0
+#endif
+
+//frames held by frameFIFO, must be a power of two
+#if !defined(ACL2_FRAME_CAPACITY)
+#define ACL2_FRAME_CAPACITY 256
+#endif
+
+//set to 1 to keep a temperature field in each frame
+#if !defined(ACL2_FRAME_TEMP)
+#define ACL2_FRAME_TEMP 0
+#endif
+
+//set to 1 to stamp every drained frame with its conversion time in micros(), kept in
+//frame.time or in timeFIFO. Costs four bytes per stored frame
+#if !defined(ACL2_FRAME_TIME)
+#define ACL2_FRAME_TIME 0
+#endif
+
+//set to 1 to number every stored frame, kept in frame.seq or in seqFIFO. Sets lost
+//to a FIFO overrun or a full queue leave a jump in the numbers
+#if !defined(ACL2_FRAME_SEQ)
+#define ACL2_FRAME_SEQ 0
+#endif
+
+//frames between the two points the sample period is measured over. Longer windows
+//average out more drain jitter, shorter ones follow the oscillator drift faster
+#if !defined(ACL2_DRIFT_WINDOW)
+#define ACL2_DRIFT_WINDOW 4096
+#endif
+
+//number of external interrupts beginInterrupt() can attach to
+#if !defined(ACL2_MAX_INTERRUPTS)
+#define ACL2_MAX_INTERRUPTS 5
+#endif
+
+//frames calibrate() collects, six bytes of stack each, the FIFO holds at most 170
+#if !defined(ACL2_CALIBRATE_FRAMES)
+#define ACL2_CALIBRATE_FRAMES 64
+#endif
+
+//samples further than this many median absolute deviations from the median are not averaged
+#if !defined(ACL2_CALIBRATE_REJECT)
+#define ACL2_CALIBRATE_REJECT 4
+#endif
+
+//time the ACL2 needs after a soft reset before it answers on the bus
+#if !defined(ACL2_RESET_US)
+#define ACL2_RESET_US 500
+#endif
+
+//pause between the register reads init() polls with
+#if !defined(ACL2_POLL_US)
+#define ACL2_POLL_US 100
+#endif
+
+//longest init() waits for PART_ID and the first sample, covers one 12.5Hz period plus turn on
+#if !defined(ACL2_STARTUP_TIMEOUT_US)
+#define ACL2_STARTUP_TIMEOUT_US 200000UL
+#endif
+
+//chip select and call overhead of one SPI transaction, used by checkThroughput()
+#if !defined(ACL2_TRANSACTION_US)
+#define ACL2_TRANSACTION_US 5
+#endif
+
+//FIFO entries read per block transfer by fillFIFO() and pollDrain(), two bytes of stack each
+#if !defined(ACL2_DRAIN_CHUNK)
+#define ACL2_DRAIN_CHUNK 96
+#endif
+
+#include "ACL2transport.h"
+#include "ACL2ring.h"
 
 
 
@@ -70,6 +152,7 @@ const uint8_t ZDATA_H = 0x13;
 const uint8_t TEMP_L = 0x14;
 const uint8_t TEMP_H = 0x15;
 const uint8_t SOFT_RESET = 0x1F;
+const uint8_t THRESH_ACT_L = 0x20;
 const uint8_t THRESH_INACT_L = 0x23;
 const uint8_t THRESH_INACT_H  = 0x24;  
 const uint8_t TIME_INACT_L = 0x25;  
@@ -80,7 +163,22 @@ const uint8_t INTMAP1  = 0x2A;
 const uint8_t INTMAP2 = 0x2B;
 const uint8_t FILTER_CTL = 0x2C;   
 const uint8_t POWER_CTL = 0x2D;
+const uint8_t SELF_TEST = 0x2E;
+
+
+//value of PART_ID
+const uint8_t ADXL362_PART_ID = 0xF2;
+
+//STATUS bits, also used as INTMAP1/INTMAP2 sources
+const uint8_t STATUS_DATA_READY = 0x01;
+const uint8_t STATUS_FIFO_READY = 0x02;
+const uint8_t STATUS_FIFO_WATERMARK = 0x04;
+const uint8_t STATUS_FIFO_OVERRUN = 0x08;
 
+//FIFO_CONTROL bits
+const uint8_t FIFO_MODE_STREAM = 0x02;
+const uint8_t FIFO_TEMP = 0x04;				//store temperature after each x, y, z set
+const uint8_t FIFO_AH = 0x08;				//MSB of the FIFO_SAMPLES watermark
 
 //command bytes
 
@@ -99,35 +197,138 @@ const uint8_t SENSOR_RANGE_4 = 0x43;     	//Sets sensor range to 4g with 100Hz O
 const uint8_t SENSOR_RANGE_2 = 0x3;      	//Sets sensor range to 2g with 100Hz ODR
 const uint8_t BEGIN_MEASURE = 0x22;     		//Begins measurement
 
+/*	Output data rates, the low three bits of FILTER_CTL
+*/
+const uint8_t ODR_12_5 = 0x00;
+const uint8_t ODR_25 = 0x01;
+const uint8_t ODR_50 = 0x02;
+const uint8_t ODR_100 = 0x03;
+const uint8_t ODR_200 = 0x04;
+const uint8_t ODR_400 = 0x05;
+
+//FILTER_CTL HALF_BW, anti-aliasing filter at half or a quarter of the ODR
+const uint8_t BANDWIDTH_ODR_2 = 0x00;
+const uint8_t BANDWIDTH_ODR_4 = 0x10;
+
+//POWER_CTL noise modes, BEGIN_MEASURE selects ultralow noise
+const uint8_t NOISE_NORMAL = 0x00;
+const uint8_t NOISE_LOW = 0x10;
+const uint8_t NOISE_ULTRALOW = 0x20;
 
 
 
+
+/*	Sample structure filled by getXYZT()
+*/
+struct ACL2sample
+{
+	int x;
+	int y;
+	int z;
+	int temp;
+};
+
+
+/*	One FIFO sample set in mg, as stored in frameFIFO
+*/
+struct ACL2frame
+{
+	int16_t x;
+	int16_t y;
+	int16_t z;
+#if ACL2_FRAME_TEMP
+	int16_t temp;
+#endif
+#if ACL2_FRAME_TIME
+	uint32_t time;				//reconstructed conversion time in micros()
+#endif
+#if ACL2_FRAME_SEQ
+	uint16_t seq;				//set number, lost sets are skipped
+#endif
+};
+
+
+/*	Bus and drain counters returned by getStats()
+*/
+struct ACL2stats
+{
+	uint32_t spiBytes;			//bytes clocked over SPI, command and address bytes included
+	uint32_t transactions;		//chip select cycles
+	uint32_t blockedUs;			//time spent in delay() inside the library
+	uint32_t drains;			//FIFO drains, from fillFIFO() or the interrupt
+	uint32_t frames;			//sample sets stored by the drains
+	uint16_t framesPerDrain;	//frames / drains, worked out by getStats()
+	uint16_t maxFrames;			//most sets stored by one drain
+	uint16_t maxEntries;		//fullest FIFO seen by a drain, in entries
+	uint32_t drainUsMin;		//shortest drain
+	uint32_t drainUsAvg;		//drainUsTotal / drains, worked out by getStats()
+	uint32_t drainUsMax;		//longest drain
+	uint32_t drainUsTotal;		//time spent draining
+	uint32_t overruns;			//FIFO overruns, as counted by getLoss()
+	uint32_t queueOverflows;	//sets dropped because the queues were full
+};
+
+
+/*	Lost data counters returned by getLoss()
+*/
+struct ACL2loss
+{
+	uint32_t overruns;			//drains that found FIFO_OVERRUN set in STATUS
+	uint32_t lostFrames;		//sets the ACL2 dropped, estimated from the time between drains
+	uint32_t queueOverflows;	//sets dropped because the queues were full
+	uint32_t lastGapSeq;		//set number of the first set after the most recent gap
+	uint32_t lastGapFrames;		//sets missing in the most recent gap
+};
+
+
+/*	Drain budget returned by checkThroughput() and setDataRate()
+*/
+struct ACL2throughput
+{
+	uint16_t entries;			//FIFO entries read per drain
+	uint32_t drainUs;			//estimated bus time of one drain
+	uint32_t intervalUs;		//time the FIFO takes to collect those entries
+	uint32_t marginUs;			//time from the watermark to an overrun, 0 when polling
+	int headroom;				//percent of the time left after the drain, negative if it cannot keep up
+};
+
+
+/*	Offsets saved by getCalibration() and loaded by setCalibration(). The blob is
+**	stored in the byte order of the board that wrote it
+*/
+const uint8_t ACL2_CALIBRATION_VERSION = 1;
+
+struct ACL2calibration
+{
+	uint8_t version;			//ACL2_CALIBRATION_VERSION
+	uint8_t range;				//range in g the offsets were measured at
+	int16_t xZero;				//offsets in mg
+	int16_t yZero;
+	int16_t zZero;
+	uint16_t checksum;			//Fletcher-16 of the fields above
+};
+
+
 /* ------------------------------------------------------------ */
 /*					Object Class Declarations					*/
 /* ------------------------------------------------------------ */
 
 
 
-class myQueue
-{
-	public:	
-		myQueue();
-		void empty();
-		int size();
-		int front();
-		int back();
-		void push_back(int value);
-		int pop_front();
-		void resetQueue();
-		void getQueue(int* outqueue);
-		
-	private:		
-		int dataQueue[512];
-		int front_ptr;
-		int back_ptr;
-		int head_ptr;
-		int tail_ptr;
-};
+//per axis sample queue, filled by fillFIFO() and emptied by the application
+typedef ACL2ring<int, 512> myQueue;
+
+//conversion times in micros() with ACL2_FRAME_TIME, one per stored sample set
+typedef ACL2ring<uint32_t, 512> timeQueue;
+
+//set numbers with ACL2_FRAME_SEQ, one per stored sample set
+typedef ACL2ring<uint16_t, 512> seqQueue;
+
+//packed sample queue used with ACL2_FRAME_STORAGE
+typedef ACL2ring<ACL2frame, ACL2_FRAME_CAPACITY> frameQueue;
+
+//buffered capture attached by setCapture(), see ACL2capture.h
+class ACL2capture;
 
 
 class ACL2
@@ -135,48 +336,218 @@ class ACL2
 	public:
 	
 		ACL2();
+#if ACL2_ARDUINO_SPI
 		void begin(int CS);
+#endif
+		bool begin(ACL2transport* transport);
 		void init();
 		
 		int getX();		
 		int getY();
 		int getZ();
 		int getTemp();		
+		void getXYZT(ACL2sample* sample);
 		uint8_t getStatus();	
 		uint8_t getRange();
+		unsigned long getStartupTime();
 		
 		uint8_t readRegister(uint8_t thisRegister);
+		void readRegisters(uint8_t firstRegister, uint8_t* values, int count);
 		void writeRegister(uint8_t thisRegister, uint8_t thisValue);	
+		void writeRegisters(uint8_t firstRegister, const uint8_t* values, int count);
+		
+		uint8_t readShadow(uint8_t thisRegister);
+		void setRegister(uint8_t thisRegister, uint8_t thisValue);
+		void commitRegisters();
+		int verifyRegisters();
 		
 		void reset();
 		void updateRange();
 		
 		void setRange(int newRange);
-		void setZero();		
+		void setZero();
+		int calibrate(int frames);
+		void getCalibration(ACL2calibration* out);
+		bool setCalibration(const ACL2calibration* in);		
 		
 		int getFIFOentries();
 		void initFIFO();
 		void fillFIFO();
+		void fillFIFO(const uint8_t* status, uint32_t when);
+		int startDrain();
+		int pollDrain(int maxEntries = ACL2_DRAIN_CHUNK);
+		bool isDraining();
+		void setCapture(ACL2capture* capture);
+		
+		void setWatermark(int entries);
+		void setTemperatureFIFO(int decimation);
+		
+		int setDataRate(uint8_t odr, uint8_t bandwidth, uint8_t noise);
+		void setSPIClock(uint32_t hz);
+		int checkThroughput(ACL2throughput* out);
+		unsigned long getOverflowTime(int entries);
+		void beginInterrupt(uint8_t interruptNumber, uint8_t intPin);
+		void endInterrupt();
+		void serviceInterrupt();
 		
 		int getData(uint8_t reg1, uint8_t reg2);		
 		
+		void getStats(ACL2stats* out);
+		void resetStats();
+		
+		void getLoss(ACL2loss* out);
+		void resetLoss();
+		uint32_t getFrameSeq();
+		
+#if ACL2_FRAME_TIME
+		uint32_t getSamplePeriod();
+		long getDrift();
+#endif
+		
+#if ACL2_FRAME_STORAGE
+		frameQueue frameFIFO;
+#else
 		myQueue xFIFO;
 		myQueue yFIFO;
 		myQueue zFIFO;
 		myQueue tempFIFO;
+#if ACL2_FRAME_TIME
+		timeQueue timeFIFO;
+#endif
+#if ACL2_FRAME_SEQ
+		seqQueue seqFIFO;
+#endif
+#endif
+		
+	protected:
+	
+		uint8_t filterConfig;	//FILTER_CTL value written by init()
+		uint8_t powerConfig;	//POWER_CTL value written by init()
+		int xZero;
+		int yZero;
+		int zZero;			
 		
 	private:	
 			
 		
-		uint16_t twosToBin(uint16_t input);		
+		int decodeData(uint16_t buffer);
+		
+		void resetShadow();
+		
+		void select();
+		void deselect();
+		void lock();
+		void unlock();
+		void drainFIFO(const uint8_t* status = 0, uint32_t when = 0);
+		void beginDrain();
+		void beginDrain(const uint8_t* status, uint32_t now);
+		void drainChunk(int maxEntries);
+		void endDrain();
+		void alignEntry(char dir, int value);
+		void storeFrame();
+		void makeFrame(ACL2frame* frame);
+		void readTemperature();
+		void resetTiming();
+		void updateTiming(uint32_t now, int frames);
+		void countOverrun(uint32_t now, int entries);
+		bool queuesFull();
+		void transfer(const uint8_t* tx, uint8_t* rx, int count);
+		void readFIFO(uint8_t* raw, int entries);
+		void wait(unsigned long us);
+		void robustSum(int16_t* values, int n, int stride, long* sum, int* kept);
+		int roundMean(long sum, int n);
+		uint16_t calibrationChecksum(const ACL2calibration* blob);
+		unsigned long odrPeriod();
+		bool poll(uint8_t thisRegister, uint8_t mask, uint8_t value, unsigned long start);
 		char getDIR(uint16_t value);
 		
-		int chipSelect;	
+		ACL2transport* bus;
+#if ACL2_ARDUINO_SPI
+		ACL2arduinoSPI arduinoBus;	//transport used by begin(CS)
+#endif
 		uint8_t range; 
-		int xZero;
-		int yZero;
-		int zZero;			
+		uint8_t scale;			//mg per LSB at the current range
+		unsigned long startupTime;	//microseconds to the first sample, 0 if start up failed
+		uint32_t spiClock;		//SPI clock in Hz, for checkThroughput()
+		uint8_t shadow[0x2E - 0x20 + 1];	//last values written to THRESH_ACT_L through SELF_TEST
+		uint16_t shadowDirty;	//registers staged by setRegister(), bit 0 = THRESH_ACT_L
+		
+		uint8_t setSize;		//entries per FIFO sample set, 3 or 4 with temperature
+		uint8_t pendingNext;	//axis of the next entry expected in pending[]
+		int pending[4];			//partial sample set carried between drains
+		int tempDecimation;		//0 no temperature, 1 in the FIFO, N read every N sets
+		int tempCountdown;		//sets left before the next decimated temperature read
+		int heldTemp;			//last decimated temperature, copied into frames
+		uint32_t frameSeq;		//number of the next sample set, lost sets included
+		uint32_t lastDrain;		//micros() when FIFO_ENTRIES was last read
+		int drainRemaining;		//entries the current drain has still to read
+		bool draining;			//a drain has been started and not yet closed
+		bool dropping;			//the last set was dropped because the queues were full
+		ACL2capture* capture;	//takes the sets instead of the queues when not 0
+		ACL2loss loss;
+#if ACL2_FRAME_TIME
+		bool timeValid;			//false until the first drain has set the phase
+		uint32_t framePeriod;	//estimated time between sample sets in 1/256 us
+		uint32_t nextTime;		//conversion time of set frameSeq in us
+		uint8_t nextFrac;		//fraction of nextTime in 1/256 us
+		uint32_t anchorTime;	//conversion time of set anchorSeq, start of the drift window
+		uint32_t anchorSeq;
+		uint32_t midTime;		//conversion time of set midSeq, next anchor once the window is full
+		uint32_t midSeq;
+#endif
+		
+		int interrupt;
+		volatile uint8_t lockDepth;
+		volatile bool drainPending;
+		
+#if ACL2_STATS
+		ACL2stats stats;
+		uint32_t overrunBase;	//getLoss() counters at the last resetStats()
+		uint32_t overflowBase;
+		uint32_t drainBusy;		//bus time of the current drain so far
+		uint32_t drainStored;	//stats.frames when the current drain began
+#endif
+		
+};
+
+/* ------------------------------------------------------------ */
+/*  ACL2fixed
+**
+**  ACL2 with the range and output data rate fixed at compile time, e.g.
+**  ACL2fixed<4, ODR_200>. init() writes the FILTER_CTL value computed from
+**  the template arguments and getX(), getY(), getZ() scale by a constant
+**  power of two. setRange() and setDataRate() are not available; use ACL2 to change
+**  range or ODR at run time
+*/
+template<int RANGE, uint8_t ODR>
+class ACL2fixed : public ACL2
+{
+	public:
+		//mg per LSB is 1, 2 or 4, a power of two the compiler turns into a shift
+		static const int SCALE_SHIFT = RANGE == 2 ? 0 : (RANGE == 4 ? 1 : 2);
+		static const uint8_t FILTER = (RANGE == 2 ? 0x00 : (RANGE == 4 ? 0x40 : 0x80)) | ODR;
+		
+		ACL2fixed(){
+			typedef char rangeMustBe2_4or8[RANGE == 2 || RANGE == 4 || RANGE == 8 ? 1 : -1];
+			(void)sizeof(rangeMustBe2_4or8);
+			filterConfig = FILTER;
+		}
+		
+		int getX(){
+			return getData(XDATA_H, XDATA_L) * (1 << SCALE_SHIFT) + xZero;
+		}
+		
+		int getY(){
+			return getData(YDATA_H, YDATA_L) * (1 << SCALE_SHIFT) + yZero;
+		}
+		
+		int getZ(){
+			return getData(ZDATA_H, ZDATA_L) * (1 << SCALE_SHIFT) + zZero;
+		}
 		
+	private:
+		using ACL2::setRange;
+		using ACL2::setDataRate;
 };
 
 #endif //ACL2_H
\ No newline at end of file
@@ -0,0 +1,468 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2bus.cpp	--	Drain scheduler for several ACL2s on one SPI bus	*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include <ACL2bus.h>
+#include <string.h>
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  permilleOf()
+**
+**	part in tenths of a percent of whole without overflowing 32 bits
+*/
+static int permilleOf(uint32_t part, uint32_t whole){
+
+	if(whole < 1000){
+		return whole == 0 ? 0 : (int)(part * 1000 / whole);
+	}
+	return (int)(part / (whole / 1000));
+
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  ACL2bus()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	constructor, starts with no devices
+*/
+ACL2bus::ACL2bus(){
+
+	count = 0;
+	started = false;
+	lastService = 0;
+	gapUs = 0;
+	for(int i = 0; i < ACL2_BUS_DEVICES; i ++){
+		devices[i] = 0;
+		notified[i] = false;
+		flagged[i] = false;
+		drainUs[i] = 0;
+	}
+	resetStatus();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  add()
+**
+**  Parameters:
+**    device - ACL2 that has been through begin() and initFIFO()
+**		notified - true if notify() is called from its FIFO watermark interrupt,
+**		false to poll its FIFO level on every service()
+**
+**  Return Value:
+**    int - index of the device for notify() and getStatus(), -1 if the bus
+**		already holds ACL2_BUS_DEVICES
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	adds a device to the bus. It is drained on the first service() call
+*/
+int ACL2bus::add(ACL2* device, bool notified){
+
+	ACL2loss loss;
+
+	if(count == ACL2_BUS_DEVICES){
+		return -1;
+	}
+
+	devices[count] = device;
+	this->notified[count] = notified;
+	flagged[count] = false;
+	drainUs[count] = 0;
+	entries[count] = 0;
+	memset(status[count], 0, sizeof(status[count]));
+	checkedAt[count] = 0;
+	slack[count] = 0;
+	minSlack[count] = 0xFFFFFFFF;
+	checks[count] = 0;
+	drains[count] = 0;
+	busUs[count] = 0;
+	device->getLoss(&loss);
+	overrunBase[count] = loss.overruns;
+	started = false;
+
+	count ++;
+	return count - 1;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getCount()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - number of devices added
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+int ACL2bus::getCount(){
+
+	return count;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getDevice()
+**
+**  Parameters:
+**    index - device index returned by add()
+**
+**  Return Value:
+**    ACL2* - the device, 0 if index is out of range
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+ACL2* ACL2bus::getDevice(int index){
+
+	if(index < 0 || index >= count){
+		return 0;
+	}
+	return devices[index];
+
+}
+
+/* ------------------------------------------------------------ */
+/*  notify()
+**
+**  Parameters:
+**    index - device index returned by add()
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	marks a device whose FIFO interrupt has fired. Only sets a flag, so it is
+**		safe to call from the interrupt handler; the drain happens in service()
+*/
+void ACL2bus::notify(int index){
+
+	if(index >= 0 && index < count){
+		flagged[index] = true;
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/*  service()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - number of devices drained
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reads the FIFO level of every polled device and every notified device
+**		that has fired, then drains them earliest overrun first. A device is
+**		drained if it was notified, if it holds at least its FIFO watermark, or if
+**		it could overrun within twice the longest recent gap between service()
+**		calls plus the drains already queued ahead of it. Devices that can wait
+**		are left for a later call, which keeps the bus free and their drains long;
+**		setWatermark() bounds how long their samples wait. The first call drains
+**		everything
+*/
+int ACL2bus::service(){
+
+	uint32_t now = micros();
+	uint32_t elapsed = 0;
+	uint32_t ahead = 0;
+	int order[ACL2_BUS_DEVICES];
+	bool due[ACL2_BUS_DEVICES];
+	int n = 0;
+	int drained = 0;
+	int j = 0;
+
+	//longest gap between calls, decaying slowly once calls speed up again
+	if(started){
+		elapsed = now - lastService;
+		if(elapsed >= gapUs){
+			gapUs = elapsed;
+		}
+		else{
+			gapUs = gapUs - ((gapUs - elapsed) >> 3);
+		}
+	}
+	lastService = now;
+
+	//check levels and sort by time to overrun, there are only a few devices
+	for(int i = 0; i < count; i ++){
+		if(notified[i] && !flagged[i] && started){
+			continue;
+		}
+		due[i] = flagged[i] || !started;
+		flagged[i] = false;
+		check(i);
+		if(entries[i] >= watermark(i)){
+			due[i] = true;
+		}
+
+		for(j = n; j > 0 && slack[order[j - 1]] > slack[i]; j --){
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+		n ++;
+	}
+
+	for(int k = 0; k < n; k ++){
+		j = order[k];
+		if(due[j] || slack[j] <= 2 * gapUs + ahead + drainUs[j]){
+			drain(j);
+			ahead = ahead + drainUs[j];
+			drained ++;
+		}
+	}
+
+	started = true;
+	return drained;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getStatus()
+**
+**  Parameters:
+**    index - device index returned by add()
+**		out - structure to fill in
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    fills out with zeros if index is out of range
+**
+**  Description:
+**   	figures for one device since add() or resetStatus()
+*/
+void ACL2bus::getStatus(int index, ACL2busStatus* out){
+
+	ACL2loss loss;
+
+	if(index < 0 || index >= count){
+		memset(out, 0, sizeof(*out));
+		return;
+	}
+
+	devices[index]->getLoss(&loss);
+	out->entries = entries[index];
+	out->slackUs = slack[index];
+	out->minSlackUs = minSlack[index];
+	out->checks = checks[index];
+	out->drains = drains[index];
+	out->busUs = busUs[index];
+	out->share = permilleOf(busUs[index], micros() - statusStart);
+	out->overruns = loss.overruns - overrunBase[index];
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getUtilization()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - tenths of a percent of the time since resetStatus() spent in checks
+**		and drains
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the sum of the device shares. As it nears 1000 the bus cannot take more
+**		devices or a higher ODR
+*/
+int ACL2bus::getUtilization(){
+
+	uint32_t total = 0;
+
+	for(int i = 0; i < count; i ++){
+		total = total + busUs[i];
+	}
+
+	return permilleOf(total, micros() - statusStart);
+
+}
+
+/* ------------------------------------------------------------ */
+/*  resetStatus()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	clears the counters reported by getStatus() and getUtilization()
+*/
+void ACL2bus::resetStatus(){
+
+	ACL2loss loss;
+
+	for(int i = 0; i < count; i ++){
+		minSlack[i] = 0xFFFFFFFF;
+		checks[i] = 0;
+		drains[i] = 0;
+		busUs[i] = 0;
+		devices[i]->getLoss(&loss);
+		overrunBase[i] = loss.overruns;
+	}
+	statusStart = micros();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  check()
+**
+**  Parameters:
+**    index - device to check
+**
+**  Return Value:
+**    unsigned long - microseconds until the device overruns
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reads STATUS and the FIFO level in one transaction and works out the time to
+**		overrun at the device's ODR. The bytes are kept for drain(). Reading STATUS
+**		clears FIFO_OVERRUN, so an overrun seen by a check that is not followed by a
+**		drain is carried over to the next check
+*/
+unsigned long ACL2bus::check(int index){
+
+	uint32_t start = micros();
+	uint8_t overrun = status[index][0] & STATUS_FIFO_OVERRUN;
+
+	devices[index]->readRegisters(STATUS, status[index], 3);
+	checkedAt[index] = micros();
+	status[index][0] = status[index][0] | overrun;
+	entries[index] = ((status[index][2] & 0x03) << 8) | status[index][1];
+	slack[index] = devices[index]->getOverflowTime(entries[index]);
+	if(slack[index] < minSlack[index]){
+		minSlack[index] = slack[index];
+	}
+	checks[index] ++;
+	busUs[index] += micros() - start;
+
+	return slack[index];
+
+}
+
+/* ------------------------------------------------------------ */
+/*  watermark()
+**
+**  Parameters:
+**    index - device to look at
+**
+**  Return Value:
+**    int - FIFO level the device was set to interrupt at
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	from the shadow copy of FIFO_SAMPLES and the FIFO_AH bit, so no bus access
+*/
+int ACL2bus::watermark(int index){
+
+	int level = devices[index]->readShadow(FIFO_SAMPLES);
+
+	if(devices[index]->readShadow(FIFO_CONTROL) & FIFO_AH){
+		level = level | 0x100;
+	}
+	return level;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  drain()
+**
+**  Parameters:
+**    index - device to drain
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	runs fillFIFO() on the device with the STATUS and FIFO_ENTRIES bytes of the
+**		last check(), so the drain does not read them again, and keeps its time for
+**		the next schedule
+*/
+void ACL2bus::drain(int index){
+
+	uint32_t start = micros();
+
+	devices[index]->fillFIFO(status[index], checkedAt[index]);
+	status[index][0] = 0;
+	drainUs[index] = micros() - start;
+	drains[index] ++;
+	busUs[index] += drainUs[index];
+
+}
@@ -0,0 +1,133 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2bus.h	--	Drain scheduler for several ACL2s on one SPI bus	*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	ACL2bus owns the drains of several ACL2s that share an SPI bus.		*/
+/*	Call service() from loop(). It reads the FIFO level of each			*/
+/*	device, works out how long each one has before it overruns at its	*/
+/*	own ODR, and drains them most urgent first. A device is only		*/
+/*	drained when it has reached its FIFO watermark or could overrun		*/
+/*	before the following service() call, judged from the longest		*/
+/*	recent gap between calls plus the drains queued ahead of it, so		*/
+/*	slow sensors are read in large blocks and fast ones are never		*/
+/*	kept waiting behind them.											*/
+/*																		*/
+/*	A device added with notified set is not polled. Call notify()		*/
+/*	from the handler of its FIFO watermark interrupt and service()		*/
+/*	checks it on its next pass. Do not also call beginInterrupt() on	*/
+/*	devices the bus manages: a drain from one device's interrupt could	*/
+/*	land in the middle of another device's transaction.					*/
+/*																		*/
+/*	  ACL2 acl[2];														*/
+/*	  ACL2bus rig;														*/
+/*	  acl[0].begin(9); acl[0].initFIFO(); rig.add(&acl[0]);				*/
+/*	  acl[1].begin(10); acl[1].initFIFO(); rig.add(&acl[1]);			*/
+/*	  ...																*/
+/*	  rig.service();													*/
+/*																		*/
+/*	getStatus() reports the bus time spent on each device, as a share	*/
+/*	of the time since resetStatus(), and its time to overrun when it	*/
+/*	was last checked.													*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2BUS_H)
+#define ACL2BUS_H
+
+//devices one ACL2bus can manage
+#if !defined(ACL2_BUS_DEVICES)
+#define ACL2_BUS_DEVICES 4
+#endif
+
+#include "ACL2.h"
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+/*	Per device figures filled by getStatus()
+*/
+struct ACL2busStatus
+{
+	uint16_t entries;			//FIFO level at the last check
+	uint32_t slackUs;			//time to overrun at the last check
+	uint32_t minSlackUs;		//least slackUs seen since resetStatus()
+	uint32_t checks;			//FIFO levels read
+	uint32_t drains;			//fillFIFO() calls made
+	uint32_t busUs;				//time spent in checks and drains
+	int share;					//busUs in tenths of a percent of the time since resetStatus()
+	uint32_t overruns;			//FIFO overruns reported by getLoss()
+};
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class ACL2bus
+{
+	public:
+		ACL2bus();
+
+		int add(ACL2* device, bool notified = false);
+		int getCount();
+		ACL2* getDevice(int index);
+
+		void notify(int index);
+		int service();
+
+		void getStatus(int index, ACL2busStatus* out);
+		int getUtilization();
+		void resetStatus();
+
+	private:
+		unsigned long check(int index);
+		int watermark(int index);
+		void drain(int index);
+
+		ACL2* devices[ACL2_BUS_DEVICES];
+		int count;
+		bool notified[ACL2_BUS_DEVICES];		//checked only after notify()
+		volatile bool flagged[ACL2_BUS_DEVICES];	//notify() since the last check
+		uint16_t entries[ACL2_BUS_DEVICES];
+		uint8_t status[ACL2_BUS_DEVICES][3];	//STATUS and FIFO_ENTRIES at the last check
+		uint32_t checkedAt[ACL2_BUS_DEVICES];	//micros() when they were read
+		uint32_t slack[ACL2_BUS_DEVICES];
+		uint32_t minSlack[ACL2_BUS_DEVICES];
+		uint32_t drainUs[ACL2_BUS_DEVICES];		//time the last drain took
+		uint32_t checks[ACL2_BUS_DEVICES];
+		uint32_t drains[ACL2_BUS_DEVICES];
+		uint32_t busUs[ACL2_BUS_DEVICES];
+		uint32_t overrunBase[ACL2_BUS_DEVICES];	//getLoss() overruns at resetStatus()
+
+		bool started;			//false until the first service()
+		uint32_t lastService;	//micros() at the start of the last service()
+		uint32_t gapUs;			//longest recent time between service() calls
+		uint32_t statusStart;	//micros() at resetStatus()
+};
+
+#endif //ACL2BUS_H
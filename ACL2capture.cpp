@@ -0,0 +1,301 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2capture.cpp	--	Double and triple buffered ACL2 capture			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include <ACL2capture.h>
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  ACL2capture()
+**
+**  Parameters:
+**    storage - buffers * size frames
+**		counts - one count per buffer
+**		size - frames per buffer
+**		buffers - number of buffers, 2 or more
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	constructor used by ACL2captureBuffers, which owns the storage
+*/
+ACL2capture::ACL2capture(ACL2frame* storage, volatile int* counts, int size, int buffers){
+
+	this->storage = storage;
+	this->counts = counts;
+	this->size = size;
+	this->buffers = buffers;
+	reset();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  swap()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - frames in the new front buffer, 0 if nothing was captured
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	gives the front buffer back to the drains and takes the oldest captured
+**		frames in its place: the next ready buffer, or the back buffer as it stands
+**		if none is ready. Only buffer indexes change. The drain interrupt is held
+**		off for those few instructions
+*/
+int ACL2capture::swap(){
+
+	uint8_t next = 0;
+
+	noInterrupts();
+
+	counts[front] = 0;
+	next = front + 1 == buffers ? 0 : front + 1;
+	if(next == back){
+		//nothing ready, the back buffer becomes the front and drains move on
+		front = back;
+		back = back + 1 == buffers ? 0 : back + 1;
+		counts[back] = 0;
+	}
+	else{
+		front = next;
+	}
+
+	interrupts();
+
+	return counts[front];
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getFront()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    const ACL2frame* - frames of the front buffer, oldest first
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the frames stay put until the next swap()
+*/
+const ACL2frame* ACL2capture::getFront(){
+
+	return storage + (int)front * size;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getFrontCount()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - frames in the front buffer
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+int ACL2capture::getFrontCount(){
+
+	return counts[front];
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getReady()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - full buffers waiting for swap(), not counting the back buffer
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	always 0 with two buffers
+*/
+int ACL2capture::getReady(){
+
+	int ready = 0;
+
+	noInterrupts();
+	ready = (int)back - (int)front - 1;
+	interrupts();
+
+	if(ready < 0){
+		ready = ready + buffers;
+	}
+	return ready;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getSize()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - frames each buffer holds
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+int ACL2capture::getSize(){
+
+	return size;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getDropped()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    uint32_t - sets dropped because every buffer but the front was full
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+uint32_t ACL2capture::getDropped(){
+
+	return dropped;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  reset()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	empties every buffer and clears the drop count
+*/
+void ACL2capture::reset(){
+
+	noInterrupts();
+	for(int i = 0; i < buffers; i ++){
+		counts[i] = 0;
+	}
+	front = buffers - 1;
+	back = 0;
+	dropped = 0;
+	interrupts();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  isFull()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    bool - true if the next set has nowhere to go
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the back buffer is full and the one after it is the front
+*/
+bool ACL2capture::isFull(){
+
+	uint8_t next = back + 1 == buffers ? 0 : back + 1;
+
+	return counts[back] >= size && next == front;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  store()
+**
+**  Parameters:
+**    frame - set to store
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	appends a set to the back buffer, first moving on to the next free buffer
+**		if the back one is full. Call only when isFull() is false
+*/
+void ACL2capture::store(const ACL2frame* frame){
+
+	uint8_t next = 0;
+
+	if(counts[back] >= size){
+		next = back + 1 == buffers ? 0 : back + 1;
+		counts[next] = 0;
+		back = next;
+	}
+
+	storage[(int)back * size + counts[back]] = *frame;
+	ACL2_BARRIER();
+	counts[back] = counts[back] + 1;
+
+}
@@ -0,0 +1,112 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2capture.h	--	Double and triple buffered ACL2 capture			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	With a capture attached by ACL2::setCapture(), drains store their	*/
+/*	sample sets as ACL2frames in a back buffer instead of the queues.	*/
+/*	The application works on the front buffer for as long as it likes	*/
+/*	and calls swap() when it is done; swap() only moves buffer			*/
+/*	indexes, whatever the buffer size. Drains keep emptying the ACL2		*/
+/*	FIFO meanwhile, so a long pass over the front buffer cannot make	*/
+/*	the part overrun.													*/
+/*																		*/
+/*	The buffers form a ring. With two, swap() exchanges front and		*/
+/*	back. With three or more, a back buffer that fills moves to a		*/
+/*	ready list and the drain carries on in the next free one; swap()	*/
+/*	hands out the oldest ready buffer first, or the part filled back	*/
+/*	buffer when none is ready. Sets only have to be dropped once every	*/
+/*	buffer but the front is full; they are counted in getDropped() and	*/
+/*	in the queueOverflows of ACL2::getLoss().							*/
+/*																		*/
+/*	  ACL2captureBuffers<128, 3> capture;								*/
+/*	  myACL.setCapture(&capture);										*/
+/*	  ...																*/
+/*	  int n = capture.swap();											*/
+/*	  const ACL2frame* frames = capture.getFront();						*/
+/*	  ...use frames[0] to frames[n - 1] until the next swap()...		*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2CAPTURE_H)
+#define ACL2CAPTURE_H
+
+#include "ACL2.h"
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class ACL2capture
+{
+	friend class ACL2;
+
+	public:
+		int swap();
+		const ACL2frame* getFront();
+		int getFrontCount();
+		int getReady();
+		int getSize();
+		uint32_t getDropped();
+		void reset();
+
+	protected:
+		ACL2capture(ACL2frame* storage, volatile int* counts, int size, int buffers);
+
+	private:
+		bool isFull();
+		void store(const ACL2frame* frame);
+
+		ACL2frame* storage;		//buffers of size frames, one after another
+		volatile int* counts;	//frames in each buffer
+		int size;
+		uint8_t buffers;
+		volatile uint8_t back;	//buffer drains store into
+		volatile uint8_t front;	//buffer the application owns
+		uint32_t dropped;
+};
+
+/* ------------------------------------------------------------ */
+/*  ACL2captureBuffers
+**
+**  Capture with the storage for BUFFERS buffers of SETS frames each
+*/
+template<int SETS, int BUFFERS = 2>
+class ACL2captureBuffers : public ACL2capture
+{
+	public:
+		ACL2captureBuffers() : ACL2capture(frames[0], counts, SETS, BUFFERS){
+			typedef char needTwoToEightBuffers[BUFFERS >= 2 && BUFFERS <= 8 && SETS > 0 ? 1 : -1];
+			(void)sizeof(needTwoToEightBuffers);
+		}
+
+	private:
+		ACL2frame frames[BUFFERS][SETS];
+		volatile int counts[BUFFERS];
+};
+
+#endif //ACL2CAPTURE_H
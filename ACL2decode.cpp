@@ -0,0 +1,351 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2decode.cpp	--	Batch decoder for raw ACL2 FIFO data			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	The scalar decoder demuxes by indexing a table of output pointers	*/
+/*	with the axis tag, so it has no data dependent branches. The SIMD	*/
+/*	decoder works on blocks of 8 sample sets (24 entries, or 32 with	*/
+/*	temperature). A block is deinterleaved, its tags are checked		*/
+/*	against the x, y, z (, t) pattern and, if they match, it is sign	*/
+/*	extended and stored 8 values per axis at a time. Anything that		*/
+/*	does not match, such as a stream that starts mid set, goes through	*/
+/*	the scalar path one entry at a time until the next block lines up	*/
+/*																		*/
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include "ACL2decode.h"
+
+#include <string.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ACL2_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define ACL2_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define ACL2_SSSE3
+#endif
+#endif
+#endif
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+
+/*	Output cursor shared by the scalar and SIMD paths. stride is 0 for a
+**	dropped output, so its values all land on sink
+*/
+struct decodeState
+{
+	int16_t* out[4];
+	int n[4];
+	int stride[4];
+	int16_t sink;
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static void initState(decodeState* st, int16_t* x, int16_t* y, int16_t* z, int16_t* t){
+	st->out[0] = x;
+	st->out[1] = y;
+	st->out[2] = z;
+	st->out[3] = t != 0 ? t : &st->sink;
+	for(int i = 0; i < 4; i ++){
+		st->n[i] = 0;
+		st->stride[i] = 1;
+	}
+	st->stride[3] = t != 0 ? 1 : 0;
+}
+
+static void finishState(decodeState* st, ACL2decodeCount* count){
+	count->x = st->n[0];
+	count->y = st->n[1];
+	count->z = st->n[2];
+	count->t = st->n[3];
+}
+
+static inline uint16_t loadEntry(const uint8_t* raw, int i){
+	return raw[2 * i] | (raw[2 * i + 1] << 8);
+}
+
+static inline void decodeEntry(decodeState* st, uint16_t entry){
+	uint8_t axis = ACL2entryAxis(entry);
+	
+	st->out[axis][st->n[axis] * st->stride[axis]] = ACL2entryValue(entry);
+	st->n[axis] ++;
+}
+
+#if defined(ACL2_NEON)
+
+/*	NEON: vld3/vld4 deinterleave the sets while loading
+*/
+static bool decodeBlock3(const uint8_t* raw, decodeState* st){
+	uint16_t block[24];
+	uint16x8x3_t v;
+	
+	memcpy(block, raw, sizeof(block));
+	v = vld3q_u16(block);
+	
+	for(int a = 0; a < 3; a ++){
+		uint16x8_t tags = vshrq_n_u16(v.val[a], 14);
+		uint64x2_t ok = vreinterpretq_u64_u16(vceqq_u16(tags, vdupq_n_u16(a)));
+		
+		if((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ULL){
+			return false;
+		}
+	}
+	for(int a = 0; a < 3; a ++){
+		int16x8_t value = vshrq_n_s16(vshlq_n_s16(vreinterpretq_s16_u16(v.val[a]), 2), 2);
+		
+		vst1q_s16(st->out[a] + st->n[a], value);
+		st->n[a] += 8;
+	}
+	return true;
+}
+
+static bool decodeBlock4(const uint8_t* raw, decodeState* st){
+	uint16_t block[32];
+	uint16x8x4_t v;
+	
+	memcpy(block, raw, sizeof(block));
+	v = vld4q_u16(block);
+	
+	for(int a = 0; a < 4; a ++){
+		uint16x8_t tags = vshrq_n_u16(v.val[a], 14);
+		uint64x2_t ok = vreinterpretq_u64_u16(vceqq_u16(tags, vdupq_n_u16(a)));
+		
+		if((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) != ~0ULL){
+			return false;
+		}
+	}
+	for(int a = 0; a < 4; a ++){
+		int16x8_t value = vshrq_n_s16(vshlq_n_s16(vreinterpretq_s16_u16(v.val[a]), 2), 2);
+		
+		if(st->stride[a] != 0){
+			vst1q_s16(st->out[a] + st->n[a], value);
+		}
+		st->n[a] += 8;
+	}
+	return true;
+}
+
+#define ACL2_HAVE_BLOCK3
+#define ACL2_HAVE_BLOCK4
+
+#elif defined(ACL2_SSE2)
+
+/*	true if every lane of v carries the axis tag a
+*/
+static inline bool tagsMatch(__m128i v, int a){
+	__m128i tags = _mm_srli_epi16(v, 14);
+	
+	return _mm_movemask_epi8(_mm_cmpeq_epi16(tags, _mm_set1_epi16(a))) == 0xFFFF;
+}
+
+static inline void storeBlock(decodeState* st, int a, __m128i v){
+	__m128i value = _mm_srai_epi16(_mm_slli_epi16(v, 2), 2);
+	
+	if(st->stride[a] != 0){
+		_mm_storeu_si128((__m128i*)(st->out[a] + st->n[a]), value);
+	}
+	st->n[a] += 8;
+}
+
+#if defined(ACL2_SSSE3)
+
+/*	SSSE3: each axis is gathered from the three input vectors with pshufb
+*/
+static bool decodeBlock3(const uint8_t* raw, decodeState* st){
+	__m128i a = _mm_loadu_si128((const __m128i*)raw);
+	__m128i b = _mm_loadu_si128((const __m128i*)(raw + 16));
+	__m128i c = _mm_loadu_si128((const __m128i*)(raw + 32));
+	__m128i x, y, z;
+	
+	x = _mm_or_si128(_mm_or_si128(
+		_mm_shuffle_epi8(a, _mm_setr_epi8(0, 1, 6, 7, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+		_mm_shuffle_epi8(b, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 2, 3, 8, 9, 14, 15, -128, -128, -128, -128))),
+		_mm_shuffle_epi8(c, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 4, 5, 10, 11)));
+	y = _mm_or_si128(_mm_or_si128(
+		_mm_shuffle_epi8(a, _mm_setr_epi8(2, 3, 8, 9, 14, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+		_mm_shuffle_epi8(b, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, 4, 5, 10, 11, -128, -128, -128, -128, -128, -128))),
+		_mm_shuffle_epi8(c, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 0, 1, 6, 7, 12, 13)));
+	z = _mm_or_si128(_mm_or_si128(
+		_mm_shuffle_epi8(a, _mm_setr_epi8(4, 5, 10, 11, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128)),
+		_mm_shuffle_epi8(b, _mm_setr_epi8(-128, -128, -128, -128, 0, 1, 6, 7, 12, 13, -128, -128, -128, -128, -128, -128))),
+		_mm_shuffle_epi8(c, _mm_setr_epi8(-128, -128, -128, -128, -128, -128, -128, -128, -128, -128, 2, 3, 8, 9, 14, 15)));
+	
+	if(!tagsMatch(x, 0) || !tagsMatch(y, 1) || !tagsMatch(z, 2)){
+		return false;
+	}
+	
+	storeBlock(st, 0, x);
+	storeBlock(st, 1, y);
+	storeBlock(st, 2, z);
+	return true;
+}
+
+#define ACL2_HAVE_BLOCK3
+
+#endif
+
+/*	SSE2: four way deinterleave is a 16 bit transpose done with unpacks
+*/
+static bool decodeBlock4(const uint8_t* raw, decodeState* st){
+	__m128i a = _mm_loadu_si128((const __m128i*)raw);
+	__m128i b = _mm_loadu_si128((const __m128i*)(raw + 16));
+	__m128i c = _mm_loadu_si128((const __m128i*)(raw + 32));
+	__m128i d = _mm_loadu_si128((const __m128i*)(raw + 48));
+	__m128i ab0 = _mm_unpacklo_epi16(a, b);
+	__m128i ab1 = _mm_unpackhi_epi16(a, b);
+	__m128i cd0 = _mm_unpacklo_epi16(c, d);
+	__m128i cd1 = _mm_unpackhi_epi16(c, d);
+	__m128i xy0 = _mm_unpacklo_epi16(ab0, ab1);
+	__m128i zt0 = _mm_unpackhi_epi16(ab0, ab1);
+	__m128i xy1 = _mm_unpacklo_epi16(cd0, cd1);
+	__m128i zt1 = _mm_unpackhi_epi16(cd0, cd1);
+	__m128i x = _mm_unpacklo_epi64(xy0, xy1);
+	__m128i y = _mm_unpackhi_epi64(xy0, xy1);
+	__m128i z = _mm_unpacklo_epi64(zt0, zt1);
+	__m128i t = _mm_unpackhi_epi64(zt0, zt1);
+	
+	if(!tagsMatch(x, 0) || !tagsMatch(y, 1) || !tagsMatch(z, 2) || !tagsMatch(t, 3)){
+		return false;
+	}
+	
+	storeBlock(st, 0, x);
+	storeBlock(st, 1, y);
+	storeBlock(st, 2, z);
+	storeBlock(st, 3, t);
+	return true;
+}
+
+#define ACL2_HAVE_BLOCK4
+
+#endif
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  ACL2decodeFIFOscalar()
+**
+**  Parameters:
+**    raw - FIFO bytes, two per entry, low byte first
+**		entries - number of entries in raw
+**		x, y, z, t - outputs for each axis, t may be 0
+**		count - number of values written to each output
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	reference decoder, one entry at a time
+*/
+void ACL2decodeFIFOscalar(const uint8_t* raw, int entries, int16_t* x, int16_t* y, int16_t* z, int16_t* t, ACL2decodeCount* count){
+	
+	decodeState st;
+	
+	initState(&st, x, y, z, t);
+	for(int i = 0; i < entries; i ++){
+		decodeEntry(&st, loadEntry(raw, i));
+	}
+	finishState(&st, count);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  ACL2decodeFIFOsimd()
+**
+**  Parameters:
+**    same as ACL2decodeFIFOscalar()
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	decodes whole blocks of sample sets with SIMD instructions where the target
+**		has them and the rest with the scalar code. Output is identical to
+**		ACL2decodeFIFOscalar()
+*/
+void ACL2decodeFIFOsimd(const uint8_t* raw, int entries, int16_t* x, int16_t* y, int16_t* z, int16_t* t, ACL2decodeCount* count){
+	
+	decodeState st;
+	int i = 0;
+	
+	initState(&st, x, y, z, t);
+	
+	while(i < entries){
+		uint16_t entry = loadEntry(raw, i);
+		
+		//a block can only start on an x entry
+		if(ACL2entryAxis(entry) == 0 && entries - i >= 4){
+			bool withTemp = ACL2entryAxis(loadEntry(raw, i + 3)) == 3;
+			
+#if defined(ACL2_HAVE_BLOCK4)
+			if(withTemp && entries - i >= 32 && decodeBlock4(raw + 2 * i, &st)){
+				i += 32;
+				continue;
+			}
+#endif
+#if defined(ACL2_HAVE_BLOCK3)
+			if(!withTemp && entries - i >= 24 && decodeBlock3(raw + 2 * i, &st)){
+				i += 24;
+				continue;
+			}
+#endif
+			(void)withTemp;
+		}
+		
+		decodeEntry(&st, entry);
+		i ++;
+	}
+	
+	finishState(&st, count);
+	
+}
+
+/* ------------------------------------------------------------ */
+/*  ACL2decodeFIFO()
+**
+**  Parameters:
+**    same as ACL2decodeFIFOscalar()
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	decodes with the SIMD path when the target has one, otherwise the scalar one
+*/
+void ACL2decodeFIFO(const uint8_t* raw, int entries, int16_t* x, int16_t* y, int16_t* z, int16_t* t, ACL2decodeCount* count){
+	
+#if defined(ACL2_HAVE_BLOCK3) || defined(ACL2_HAVE_BLOCK4)
+	ACL2decodeFIFOsimd(raw, entries, x, y, z, t, count);
+#else
+	ACL2decodeFIFOscalar(raw, entries, x, y, z, t, count);
+#endif
+	
+}
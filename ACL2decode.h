@@ -0,0 +1,84 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2decode.h	--	Batch decoder for raw ACL2 FIFO data			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Turns raw FIFO bytes, as clocked out after FIFO_READ (two bytes		*/
+/*	per entry, low byte first), into separate x, y, z and temperature	*/
+/*	arrays of signed counts. Each entry carries its axis in bits 15:14	*/
+/*	and the 12 bit sample sign extended to 14 bits in bits 13:0.		*/
+/*																		*/
+/*	ACL2decodeFIFOscalar() is the portable reference.					*/
+/*	ACL2decodeFIFOsimd() gives the same results using SSE2/SSSE3 or		*/
+/*	NEON when the compiler targets them, and falls back to the scalar	*/
+/*	code otherwise. ACL2decodeFIFO() picks the fastest one available.	*/
+/*	None of these depend on the Arduino core, so captures can be		*/
+/*	decoded on a PC.													*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2DECODE_H)
+#define ACL2DECODE_H
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+/*	Number of values written to each output by the decoders
+*/
+struct ACL2decodeCount
+{
+	int x;
+	int y;
+	int z;
+	int t;
+};
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+/*	axis of a FIFO entry, 0 = x, 1 = y, 2 = z, 3 = temperature
+*/
+static inline uint8_t ACL2entryAxis(uint16_t entry){
+	return entry >> 14;
+}
+
+/*	signed value of a FIFO entry, sign extended from bit 13 without branching
+*/
+static inline int16_t ACL2entryValue(uint16_t entry){
+	return (int16_t)(entry << 2) >> 2;
+}
+
+/*	Each output must have room for every entry that may belong to it (entries is
+**	always enough). t may be 0 to drop temperature entries; they are still counted
+*/
+void ACL2decodeFIFO(const uint8_t* raw, int entries, int16_t* x, int16_t* y, int16_t* z, int16_t* t, ACL2decodeCount* count);
+void ACL2decodeFIFOscalar(const uint8_t* raw, int entries, int16_t* x, int16_t* y, int16_t* z, int16_t* t, ACL2decodeCount* count);
+void ACL2decodeFIFOsimd(const uint8_t* raw, int entries, int16_t* x, int16_t* y, int16_t* z, int16_t* t, ACL2decodeCount* count);
+
+#endif //ACL2DECODE_H
@@ -0,0 +1,360 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2ring.h	--	Ring buffer used for the ACL2 sample queues			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Fixed size single producer / single consumer ring buffer. SIZE		*/
+/*	must be a power of two. The producer (push_back(), push()) only		*/
+/*	writes the tail index and the consumer (pop_front(), pop(),			*/
+/*	getQueue(), empty()) only writes the head index, so one side may	*/
+/*	run in an interrupt handler, or on another core, without locking.	*/
+/*	Each side publishes its index with a release store after touching	*/
+/*	the buffer and reads the other side's with an acquire load before	*/
+/*	touching it. A push into a full buffer is refused and counted in	*/
+/*	overflows()															*/
+/*																		*/
+/*	view() hands the consumer a pointer straight into the buffer, so	*/
+/*	items can be processed in place and then dropped with release():	*/
+/*																		*/
+/*	  const int* items;													*/
+/*	  int n;															*/
+/*	  while((n = xFIFO.view(&items)) > 0){								*/
+/*	    ...use items[0] to items[n - 1]...								*/
+/*	    xFIFO.release(n);												*/
+/*	  }																	*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2RING_H)
+#define ACL2RING_H
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+//keeps the compiler from moving memory accesses across it, enough on a single core
+#define ACL2_BARRIER()	__asm__ __volatile__("" ::: "memory")
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+template<typename T, int SIZE>
+class ACL2ring
+{
+	public:
+		ACL2ring();
+		void empty();
+		int size();
+		int capacity();
+		T front();
+		T back();
+		bool push_back(T value);
+		int push(const T* values, int count);
+		T pop_front();
+		int pop(T* values, int count);
+		void resetQueue();
+		int getQueue(T* outqueue);
+		int view(const T** items);
+		void release(int count);
+		uint32_t overflows();
+		
+	private:
+		uint16_t loadIndex(const uint16_t* index);
+		void storeIndex(uint16_t* index, uint16_t value);
+		
+		T dataQueue[SIZE];
+		uint16_t head;				//next slot to read, written by the consumer
+		uint16_t tail;				//next slot to write, written by the producer
+		volatile uint32_t overflowCount;
+};
+
+/* ------------------------------------------------------------ */
+/*					Template Definitions						*/
+/* ------------------------------------------------------------ */
+
+/* 	ACL2ring()
+**
+**  Description:
+**    Constructor, starts with an empty buffer
+*/
+template<typename T, int SIZE>
+ACL2ring<T, SIZE>::ACL2ring(){
+	//indices run freely and are masked on access
+	typedef char sizeMustBePowerOfTwo[(SIZE & (SIZE - 1)) == 0 && SIZE <= 32768 ? 1 : -1];
+	(void)sizeof(sizeMustBePowerOfTwo);
+	
+	head = 0;
+	tail = 0;
+	overflowCount = 0;
+}
+
+/* 	loadIndex()
+**
+**  Description:
+**    reads an index the other side may be changing, with acquire ordering
+**		so the buffer reads that follow see what was written before the
+**		index was stored. 16 bit accesses are not atomic on 8 bit cores, so
+**		interrupts are held off there; cli() is also a compiler barrier
+*/
+template<typename T, int SIZE>
+uint16_t ACL2ring<T, SIZE>::loadIndex(const uint16_t* index){
+#if defined(__AVR__)
+	uint8_t sreg = SREG;
+	uint16_t result;
+	
+	cli();
+	result = *(const volatile uint16_t*)index;
+	SREG = sreg;
+	return result;
+#else
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/* 	storeIndex()
+**
+**  Description:
+**    publishes an index with release ordering, after the buffer accesses
+**		before it. Held off from interrupts on 8 bit cores like loadIndex()
+*/
+template<typename T, int SIZE>
+void ACL2ring<T, SIZE>::storeIndex(uint16_t* index, uint16_t value){
+#if defined(__AVR__)
+	uint8_t sreg = SREG;
+	
+	cli();
+	*(volatile uint16_t*)index = value;
+	SREG = sreg;
+#else
+	__atomic_store_n(index, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/* 	empty()
+**
+**  Description:
+**    discards everything in the buffer. Consumer side, O(1)
+*/
+template<typename T, int SIZE>
+void ACL2ring<T, SIZE>::empty(){
+	storeIndex(&head, loadIndex(&tail));
+}
+
+/* 	size()
+**
+**  Description:
+**    number of items in the buffer
+*/
+template<typename T, int SIZE>
+int ACL2ring<T, SIZE>::size(){
+	return (uint16_t)(loadIndex(&tail) - loadIndex(&head));
+}
+
+/* 	capacity()
+**
+**  Description:
+**    number of items the buffer can hold
+*/
+template<typename T, int SIZE>
+int ACL2ring<T, SIZE>::capacity(){
+	return SIZE;
+}
+
+/* 	front()
+**
+**  Description:
+**    the oldest item, without removing it
+*/
+template<typename T, int SIZE>
+T ACL2ring<T, SIZE>::front(){
+	return dataQueue[loadIndex(&head) & (SIZE - 1)];
+}
+
+/* 	back()
+**
+**  Description:
+**    the newest item
+*/
+template<typename T, int SIZE>
+T ACL2ring<T, SIZE>::back(){
+	return dataQueue[(uint16_t)(loadIndex(&tail) - 1) & (SIZE - 1)];
+}
+
+/* 	push_back()
+**
+**  Description:
+**    adds value at the back. Returns false and counts an overflow
+**		if the buffer is full. Producer side
+*/
+template<typename T, int SIZE>
+bool ACL2ring<T, SIZE>::push_back(T value){
+	uint16_t t = tail;
+	
+	if((uint16_t)(t - loadIndex(&head)) >= SIZE){
+		overflowCount = overflowCount + 1;
+		return false;
+	}
+	
+	dataQueue[t & (SIZE - 1)] = value;
+	storeIndex(&tail, t + 1);
+	return true;
+}
+
+/* 	push()
+**
+**  Description:
+**    adds up to count values and publishes them with a single index
+**		update. Returns the number added; the rest count as overflows
+*/
+template<typename T, int SIZE>
+int ACL2ring<T, SIZE>::push(const T* values, int count){
+	uint16_t t = tail;
+	int space = SIZE - (uint16_t)(t - loadIndex(&head));
+	
+	if(count > space){
+		overflowCount = overflowCount + (count - space);
+		count = space;
+	}
+	
+	for(int i = 0; i < count; i ++){
+		dataQueue[(uint16_t)(t + i) & (SIZE - 1)] = values[i];
+	}
+	storeIndex(&tail, t + count);
+	return count;
+}
+
+/* 	pop_front()
+**
+**  Description:
+**    removes and returns the oldest item, or 0 if the buffer is empty.
+**		Consumer side
+*/
+template<typename T, int SIZE>
+T ACL2ring<T, SIZE>::pop_front(){
+	uint16_t h = head;
+	T result = T();
+	
+	if(h != loadIndex(&tail)){
+		result = dataQueue[h & (SIZE - 1)];
+		storeIndex(&head, h + 1);
+	}
+	return result;
+}
+
+/* 	pop()
+**
+**  Description:
+**    removes up to count of the oldest items into values and returns
+**		the number removed
+*/
+template<typename T, int SIZE>
+int ACL2ring<T, SIZE>::pop(T* values, int count){
+	uint16_t h = head;
+	int available = (uint16_t)(loadIndex(&tail) - h);
+	
+	if(count > available){
+		count = available;
+	}
+	
+	for(int i = 0; i < count; i ++){
+		values[i] = dataQueue[(uint16_t)(h + i) & (SIZE - 1)];
+	}
+	storeIndex(&head, h + count);
+	return count;
+}
+
+/* 	resetQueue()
+**
+**  Description:
+**    empties the buffer and clears the overflow count
+*/
+template<typename T, int SIZE>
+void ACL2ring<T, SIZE>::resetQueue(){
+	empty();
+	overflowCount = 0;
+}
+
+/* 	getQueue()
+**
+**  Description:
+**    moves everything in the buffer into outqueue, which must have room
+**		for SIZE items, and returns the number of items moved
+*/
+template<typename T, int SIZE>
+int ACL2ring<T, SIZE>::getQueue(T* outqueue){
+	return pop(outqueue, SIZE);
+}
+
+/* 	view()
+**
+**  Description:
+**    points items at the oldest item and returns how many items follow
+**		it contiguously, which is less than size() when the data wraps past
+**		the end of the buffer. The items stay valid until release()
+*/
+template<typename T, int SIZE>
+int ACL2ring<T, SIZE>::view(const T** items){
+	uint16_t h = head;
+	int available = (uint16_t)(loadIndex(&tail) - h);
+	int contiguous = SIZE - (h & (SIZE - 1));
+	
+	*items = &dataQueue[h & (SIZE - 1)];
+	return available < contiguous ? available : contiguous;
+}
+
+/* 	release()
+**
+**  Description:
+**    drops the count oldest items, normally after they were used
+**		through view()
+*/
+template<typename T, int SIZE>
+void ACL2ring<T, SIZE>::release(int count){
+	uint16_t h = head;
+	int available = (uint16_t)(loadIndex(&tail) - h);
+	
+	if(count > available){
+		count = available;
+	}
+	if(count > 0){
+		storeIndex(&head, h + count);
+	}
+}
+
+/* 	overflows()
+**
+**  Description:
+**    number of items refused because the buffer was full since the
+**		last resetQueue()
+*/
+template<typename T, int SIZE>
+uint32_t ACL2ring<T, SIZE>::overflows(){
+	return overflowCount;
+}
+
+#endif //ACL2RING_H
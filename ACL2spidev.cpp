@@ -0,0 +1,366 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2spidev.cpp	--	Linux spidev transport for the ACL2 driver		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include <ACL2spidev.h>
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  ACL2spidev()
+**
+**  Parameters:
+**    device - path of the spidev node, e.g. "/dev/spidev0.0". Must stay valid
+**		speed - SPI clock in Hz
+**		mode - SPI_MODE_0 to SPI_MODE_3, the ADXL362 uses mode 0
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	the device is not opened until begin()
+*/
+ACL2spidev::ACL2spidev(const char* device, uint32_t speed, uint8_t mode){
+
+	path = device;
+	fd = -1;
+	this->speed = speed;
+	this->mode = mode;
+	error = 0;
+	messages = 0;
+	queued = 0;
+	held = false;
+	byteTx = 0;
+	byteRx = 0;
+
+}
+
+ACL2spidev::~ACL2spidev(){
+
+	end();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    bool - true if the device was opened and configured
+**
+**  Errors:
+**    returns false and keeps errno for getError() if the device cannot be
+**		opened or does not accept the mode, word size or speed
+**
+**  Description:
+**   	opens the spidev node and sets mode 0, 8 bit words and the clock
+*/
+bool ACL2spidev::begin(){
+
+	uint8_t bits = 8;
+
+	end();
+
+	fd = open(path, O_RDWR);
+	if(fd < 0){
+		error = errno;
+		return false;
+	}
+
+	if(ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+		ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+		ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0){
+		error = errno;
+		end();
+		return false;
+	}
+
+	error = 0;
+	return true;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  end()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	closes the device
+*/
+void ACL2spidev::end(){
+
+	if(fd >= 0){
+		close(fd);
+		fd = -1;
+	}
+	queued = 0;
+	held = false;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  select()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	starts a new batch. The kernel lowers chip select when the batch is sent
+*/
+void ACL2spidev::select(){
+
+	queued = 0;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  deselect()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	sends the queued transfers as one message and lets chip select go high
+**		at its end. The rx buffers of the transaction are filled on return
+*/
+void ACL2spidev::deselect(){
+
+	flush(false);
+
+}
+
+/* ------------------------------------------------------------ */
+/*  transfer()
+**
+**  Parameters:
+**    data - byte to send
+**
+**  Return Value:
+**    uint8_t - byte received, 0 if the message failed
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	queues the byte behind anything already queued and sends the batch
+**		straight away, keeping chip select low for the rest of the transaction
+*/
+uint8_t ACL2spidev::transfer(uint8_t data){
+
+	byteTx = data;
+	byteRx = 0;
+	queue(&byteTx, &byteRx, 1);
+	flush(true);
+
+	return byteRx;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  transfer()
+**
+**  Parameters:
+**    tx - bytes to send, 0 to send zeros
+**		rx - buffer for the bytes received, 0 to discard them
+**		count - number of bytes
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	queues the transfer; rx is filled by the time deselect() returns
+*/
+void ACL2spidev::transfer(const uint8_t* tx, uint8_t* rx, int count){
+
+	if(count > 0){
+		queue(tx, rx, count);
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getError()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - errno of the last failed open or ioctl, 0 if none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	a failed message also clears the rx buffers it would have filled
+*/
+int ACL2spidev::getError(){
+
+	return error;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getMessages()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    uint32_t - number of SPI_IOC_MESSAGE ioctls issued
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	compare with ACL2stats.transactions to see how well transfers are batched
+*/
+uint32_t ACL2spidev::getMessages(){
+
+	return messages;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  queue()
+**
+**  Parameters:
+**    tx - bytes to send, 0 to send zeros
+**		rx - buffer for the bytes received, 0 to discard them
+**		count - number of bytes, 0 for an empty transfer
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	adds one spi_ioc_transfer to the batch, sending the batch first with chip
+**		select held if it is full
+*/
+void ACL2spidev::queue(const uint8_t* tx, uint8_t* rx, int count){
+
+	struct spi_ioc_transfer* xfer;
+
+	if(queued == ACL2_SPIDEV_BATCH){
+		flush(true);
+	}
+
+	xfer = &batch[queued];
+	memset(xfer, 0, sizeof(*xfer));
+	xfer->tx_buf = (unsigned long)tx;
+	xfer->rx_buf = (unsigned long)rx;
+	xfer->len = count;
+	xfer->speed_hz = speed;
+	xfer->bits_per_word = 8;
+	queued ++;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  flush()
+**
+**  Parameters:
+**    hold - true to leave chip select low after the message
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    a failed ioctl is kept for getError() and the rx buffers of the batch
+**		are cleared
+**
+**  Description:
+**   	sends the batch as one SPI_IOC_MESSAGE. Releasing chip select after an
+**		early flush with nothing queued sends an empty transfer
+*/
+void ACL2spidev::flush(bool hold){
+
+	if(queued == 0){
+		if(hold || !held){
+			return;
+		}
+		queue(0, 0, 0);
+	}
+
+	batch[queued - 1].cs_change = hold ? 1 : 0;
+
+	messages ++;
+	if(fd < 0 || ioctl(fd, SPI_IOC_MESSAGE(queued), batch) < 0){
+		error = fd < 0 ? EBADF : errno;
+		for(int i = 0; i < queued; i ++){
+			if(batch[i].rx_buf != 0){
+				memset((void*)(unsigned long)batch[i].rx_buf, 0, batch[i].len);
+			}
+		}
+	}
+
+	held = hold;
+	queued = 0;
+
+}
+
+#endif //__linux__
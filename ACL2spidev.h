@@ -0,0 +1,102 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2spidev.h	--	Linux spidev transport for the ACL2 driver		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Runs the ACL2 driver on a Linux SPI controller through				*/
+/*	/dev/spidevB.C. The kernel drives chip select, so select() only		*/
+/*	starts a batch: buffer transfers are queued as spi_ioc_transfer		*/
+/*	entries and deselect() hands the whole transaction to the driver	*/
+/*	in one SPI_IOC_MESSAGE ioctl. A register read is then one system	*/
+/*	call instead of three, and a FIFO drain one per chunk.				*/
+/*																		*/
+/*	transfer(data) needs its answer straight away, so it and a full		*/
+/*	queue send what is queued early, with chip select held between		*/
+/*	the two messages.													*/
+/*																		*/
+/*	Build for Linux with -DACL2_ARDUINO_SPI=0 and the timing functions	*/
+/*	from extras/host/ArduinoHost.cpp:									*/
+/*																		*/
+/*	  ACL2spidev bus("/dev/spidev0.0", 4000000);						*/
+/*	  ACL2 myACL2;														*/
+/*	  myACL2.begin(&bus);												*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2SPIDEV_H)
+#define ACL2SPIDEV_H
+
+#if defined(__linux__) && !defined(ARDUINO)
+
+//transfers queued per SPI_IOC_MESSAGE
+#if !defined(ACL2_SPIDEV_BATCH)
+#define ACL2_SPIDEV_BATCH 8
+#endif
+
+#include "ACL2transport.h"
+#include <linux/spi/spidev.h>
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class ACL2spidev : public ACL2transport
+{
+	public:
+		ACL2spidev(const char* device, uint32_t speed = 4000000UL, uint8_t mode = SPI_MODE_0);
+		~ACL2spidev();
+
+		bool begin();
+		void end();
+		void select();
+		void deselect();
+		uint8_t transfer(uint8_t data);
+		void transfer(const uint8_t* tx, uint8_t* rx, int count);
+
+		int getError();
+		uint32_t getMessages();
+
+	private:
+		void queue(const uint8_t* tx, uint8_t* rx, int count);
+		void flush(bool hold);
+
+		const char* path;
+		int fd;
+		uint32_t speed;
+		uint8_t mode;
+		int error;				//errno of the last failure, 0 if none
+		uint32_t messages;		//SPI_IOC_MESSAGE ioctls issued
+		int queued;				//transfers in batch[]
+		bool held;				//chip select left asserted by an early flush
+		struct spi_ioc_transfer batch[ACL2_SPIDEV_BATCH];
+		uint8_t byteTx;			//buffers for transfer(data)
+		uint8_t byteRx;
+};
+
+#endif //__linux__
+
+#endif //ACL2SPIDEV_H
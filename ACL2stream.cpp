@@ -0,0 +1,547 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2stream.cpp	--	Compact binary framing for ACL2 sample sets		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include <ACL2stream.h>
+#include <string.h>
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+
+//a zigzag varint of a 32 bit value is at most 5 bytes
+#define VARINT_MAX	5
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  ACL2streamCRC()
+**
+**  Parameters:
+**    data - bytes to check
+**		count - number of bytes
+**
+**  Return Value:
+**    uint16_t - CRC-16/CCITT of the bytes, polynomial 0x1021 starting from 0xFFFF
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	bit at a time, which keeps a 512 byte table out of flash
+*/
+uint16_t ACL2streamCRC(const uint8_t* data, int count){
+
+	uint16_t crc = 0xFFFF;
+
+	for(int i = 0; i < count; i ++){
+		crc = crc ^ ((uint16_t)data[i] << 8);
+		for(int bit = 0; bit < 8; bit ++){
+			if(crc & 0x8000){
+				crc = (crc << 1) ^ 0x1021;
+			}
+			else{
+				crc = crc << 1;
+			}
+		}
+	}
+
+	return crc;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  ACL2streamEncoder()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	constructor, the first packet is number 0 and starts at set 0
+*/
+ACL2streamEncoder::ACL2streamEncoder(){
+
+	reset();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  reset()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	drops the open packet and starts the packet and set numbers from 0
+*/
+void ACL2streamEncoder::reset(){
+
+	length = 0;
+	closed = false;
+	number = 0;
+	nextSet = 0;
+	last[0] = 0;
+	last[1] = 0;
+	last[2] = 0;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  add()
+**
+**  Parameters:
+**    x, y, z - sample set to add
+**		set - set number, e.g. from ACL2frame.seq. Without it the set is taken to
+**		follow on from the last one added
+**
+**  Return Value:
+**    bool - true if the set was added, false if it has to go in a new packet
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	appends a set to the open packet, or opens a new one after finish(). Returns
+**		false without adding anything when the packet is full or the set number
+**		does not follow on; call finish(), send the packet and add the set again:
+**
+**		  if(!stream.add(x, y, z)){
+**		    Serial.write(stream.getPacket(), stream.finish());
+**		    stream.add(x, y, z);
+**		  }
+*/
+bool ACL2streamEncoder::add(int x, int y, int z){
+
+	return add(x, y, z, nextSet);
+
+}
+
+bool ACL2streamEncoder::add(int x, int y, int z, uint16_t set){
+
+	uint8_t values[3 * VARINT_MAX];
+	int n = 0;
+
+	if(length == 0 || closed){
+		//new packet, the first set goes in as it is
+		packet[0] = ACL2_STREAM_SYNC1;
+		packet[1] = ACL2_STREAM_SYNC2;
+		packet[2] = 0;
+		packet[3] = number;
+		packet[4] = 0;
+		packet[5] = set & 0xFF;
+		packet[6] = set >> 8;
+		length = ACL2_STREAM_HEADER;
+		closed = false;
+		last[0] = 0;
+		last[1] = 0;
+		last[2] = 0;
+	}
+	else if(set != nextSet || packet[4] == 255){
+		return false;
+	}
+
+	n = putValue(x - last[0], values);
+	n = n + putValue(y - last[1], values + n);
+	n = n + putValue(z - last[2], values + n);
+	if(length + n > ACL2_STREAM_HEADER + ACL2_STREAM_MAX_PAYLOAD){
+		return false;
+	}
+
+	memcpy(packet + length, values, n);
+	length = length + n;
+	packet[4] ++;
+	last[0] = x;
+	last[1] = y;
+	last[2] = z;
+	nextSet = set + 1;
+
+	return true;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  finish()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - bytes in the finished packet, 0 if there was no open packet
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	fills in the length and CRC. The packet stays in getPacket() until the
+**		next add()
+*/
+int ACL2streamEncoder::finish(){
+
+	uint16_t crc = 0;
+
+	if(length == 0 || closed){
+		return 0;
+	}
+
+	packet[2] = length - ACL2_STREAM_HEADER;
+	crc = ACL2streamCRC(packet + 2, length - 2);
+	packet[length] = crc & 0xFF;
+	packet[length + 1] = crc >> 8;
+	length = length + 2;
+	closed = true;
+	number ++;
+
+	return length;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  getPacket()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    const uint8_t* - bytes of the packet last finished
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+const uint8_t* ACL2streamEncoder::getPacket(){
+
+	return packet;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  putValue()
+**
+**  Parameters:
+**    value - signed value to code
+**		out - at least VARINT_MAX bytes
+**
+**  Return Value:
+**    int - bytes written
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	zigzag maps 0, -1, 1, -2 ... to 0, 1, 2, 3 ... so small differences of
+**		either sign take one byte, then seven bits go in each byte, low first,
+**		with the top bit set on all but the last
+*/
+int ACL2streamEncoder::putValue(int value, uint8_t* out){
+
+	uint32_t code = ((uint32_t)(int32_t)value << 1) ^ (uint32_t)((int32_t)value >> 31);
+	int n = 0;
+
+	while(code >= 0x80){
+		out[n++] = (code & 0x7F) | 0x80;
+		code = code >> 7;
+	}
+	out[n++] = code;
+
+	return n;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  ACL2streamDecoder()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	constructor
+*/
+ACL2streamDecoder::ACL2streamDecoder(){
+
+	reset();
+
+}
+
+/* ------------------------------------------------------------ */
+/*  reset()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	forgets buffered bytes and clears the counters
+*/
+void ACL2streamDecoder::reset(){
+
+	have = 0;
+	sets = 0;
+	firstSet = 0;
+	synced = false;
+	nextPacket = 0;
+	nextSet = 0;
+	packets = 0;
+	crcErrors = 0;
+	skipped = 0;
+	lostPackets = 0;
+	lostSets = 0;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  push()
+**
+**  Parameters:
+**    data - next byte from the link
+**
+**  Return Value:
+**    int - sets in a packet this byte completed, 0 if none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	when it returns more than 0 the sets can be read through getX(), getY(),
+**		getZ() and getFirstSet() until the next push()
+*/
+int ACL2streamDecoder::push(uint8_t data){
+
+	if(have == ACL2_STREAM_PACKET){
+		drop(1);
+		skipped ++;
+	}
+	buffer[have++] = data;
+
+	return parse();
+
+}
+
+const int* ACL2streamDecoder::getX(){
+	return x;
+}
+
+const int* ACL2streamDecoder::getY(){
+	return y;
+}
+
+const int* ACL2streamDecoder::getZ(){
+	return z;
+}
+
+int ACL2streamDecoder::getSets(){
+	return sets;
+}
+
+uint16_t ACL2streamDecoder::getFirstSet(){
+	return firstSet;
+}
+
+uint32_t ACL2streamDecoder::getPackets(){
+	return packets;
+}
+
+uint32_t ACL2streamDecoder::getCRCErrors(){
+	return crcErrors;
+}
+
+uint32_t ACL2streamDecoder::getSkipped(){
+	return skipped;
+}
+
+uint32_t ACL2streamDecoder::getLostPackets(){
+	return lostPackets;
+}
+
+uint32_t ACL2streamDecoder::getLostSets(){
+	return lostSets;
+}
+
+/* ------------------------------------------------------------ */
+/*  parse()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    int - sets in the packet found, 0 if there is no complete packet yet
+**
+**  Errors:
+**    a candidate with a bad length, CRC or payload is counted in getCRCErrors()
+**		and only its first byte is dropped, so a real packet inside it is found
+**
+**  Description:
+**   	looks for a packet at the start of the buffer, throwing bytes away until
+**		one could start there
+*/
+int ACL2streamDecoder::parse(){
+
+	int total = 0;
+	uint16_t crc = 0;
+	uint8_t packet = 0;
+
+	while(have > 0){
+		if(buffer[0] != ACL2_STREAM_SYNC1 ||
+			(have > 1 && buffer[1] != ACL2_STREAM_SYNC2) ||
+			(have > 2 && buffer[2] > ACL2_STREAM_MAX_PAYLOAD)){
+			drop(1);
+			skipped ++;
+			continue;
+		}
+
+		total = ACL2_STREAM_HEADER + (have > 2 ? buffer[2] : 0) + 2;
+		if(have < ACL2_STREAM_HEADER || have < total){
+			return 0;
+		}
+
+		crc = buffer[total - 2] | (buffer[total - 1] << 8);
+		if(crc != ACL2streamCRC(buffer + 2, total - 4) || !decode()){
+			crcErrors ++;
+			drop(1);
+			skipped ++;
+			continue;
+		}
+
+		//count what went missing since the last good packet
+		packet = buffer[3];
+		firstSet = buffer[5] | (buffer[6] << 8);
+		if(synced){
+			lostPackets = lostPackets + (uint8_t)(packet - nextPacket);
+			lostSets = lostSets + (uint16_t)(firstSet - nextSet);
+		}
+		synced = true;
+		nextPacket = packet + 1;
+		nextSet = firstSet + sets;
+		packets ++;
+
+		drop(total);
+		return sets;
+	}
+
+	return 0;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  decode()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    bool - true if the payload holds exactly the sets the header gives
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	undoes the varint, zigzag and difference coding into x[], y[] and z[]
+*/
+bool ACL2streamDecoder::decode(){
+
+	int count = buffer[4];
+	int end = ACL2_STREAM_HEADER + buffer[2];
+	int pos = ACL2_STREAM_HEADER;
+	int value[3] = {0, 0, 0};
+	uint32_t code = 0;
+	int shift = 0;
+
+	if(count > ACL2_STREAM_MAX_SETS){
+		return false;
+	}
+
+	for(int i = 0; i < count; i ++){
+		for(int axis = 0; axis < 3; axis ++){
+			code = 0;
+			shift = 0;
+			do{
+				if(pos == end || shift > 28){
+					return false;
+				}
+				code = code | ((uint32_t)(buffer[pos] & 0x7F) << shift);
+				shift = shift + 7;
+			}while(buffer[pos++] & 0x80);
+			value[axis] = value[axis] + (int32_t)((code >> 1) ^ (0 - (code & 1)));
+		}
+		x[i] = value[0];
+		y[i] = value[1];
+		z[i] = value[2];
+	}
+
+	sets = count;
+	return pos == end;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  drop()
+**
+**  Parameters:
+**    count - bytes to remove from the front of the buffer
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**
+*/
+void ACL2streamDecoder::drop(int count){
+
+	have = have - count;
+	memmove(buffer, buffer + count, have);
+
+}
@@ -0,0 +1,151 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2stream.h	--	Compact binary framing for ACL2 sample sets		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Packs x, y, z sample sets into packets for a serial link and		*/
+/*	unpacks them on the other side. A packet is:						*/
+/*																		*/
+/*	  0xA5 0x5A		sync word											*/
+/*	  length		payload bytes, at most ACL2_STREAM_MAX_PAYLOAD		*/
+/*	  packet		packet number, counts up and wraps at 256			*/
+/*	  sets			sample sets in the payload							*/
+/*	  first			set number of the first set, 16 bits low first		*/
+/*	  payload		x, y, z of the first set, then of each later set	*/
+/*					its difference from the set before; every value		*/
+/*					zigzag coded as a base 128 varint					*/
+/*	  crc			CRC-16/CCITT (0x1021, start 0xFFFF) of length		*/
+/*					through payload, low byte first						*/
+/*																		*/
+/*	Sets in a packet follow on one from the next; a skipped set number	*/
+/*	starts a new packet. At rest each set takes about three bytes, so	*/
+/*	400Hz fits in well under 19200 baud.								*/
+/*																		*/
+/*	ACL2streamDecoder takes the bytes one at a time. A packet with a	*/
+/*	bad length or CRC costs its first byte and the search for the		*/
+/*	sync word starts again from the next one, so dropped or corrupted	*/
+/*	bytes lose at most the packets they touch. Gaps in packet and set	*/
+/*	numbers are counted.												*/
+/*																		*/
+/*	Neither class depends on the Arduino core, so the decoder also		*/
+/*	builds on a PC, see extras/host/StreamDump.cpp.						*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2STREAM_H)
+#define ACL2STREAM_H
+
+//most payload bytes in one packet, at most 255
+#if !defined(ACL2_STREAM_MAX_PAYLOAD)
+#define ACL2_STREAM_MAX_PAYLOAD 240
+#endif
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+const uint8_t ACL2_STREAM_SYNC1 = 0xA5;
+const uint8_t ACL2_STREAM_SYNC2 = 0x5A;
+const int ACL2_STREAM_HEADER = 7;			//sync word to first set number
+const int ACL2_STREAM_PACKET = ACL2_STREAM_HEADER + ACL2_STREAM_MAX_PAYLOAD + 2;
+const int ACL2_STREAM_MAX_SETS = ACL2_STREAM_MAX_PAYLOAD / 3;
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+uint16_t ACL2streamCRC(const uint8_t* data, int count);
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class ACL2streamEncoder
+{
+	public:
+		ACL2streamEncoder();
+
+		void reset();
+		bool add(int x, int y, int z);
+		bool add(int x, int y, int z, uint16_t set);
+		int finish();
+		const uint8_t* getPacket();
+
+	private:
+		int putValue(int value, uint8_t* out);
+
+		uint8_t packet[ACL2_STREAM_PACKET];
+		int length;				//bytes in packet[], 0 until the first set is added
+		bool closed;			//finish() has run on the packet in packet[]
+		uint8_t number;			//number of the next packet
+		uint16_t nextSet;		//set number that follows on in the open packet
+		int last[3];			//x, y, z of the last set added
+};
+
+class ACL2streamDecoder
+{
+	public:
+		ACL2streamDecoder();
+
+		void reset();
+		int push(uint8_t data);
+
+		const int* getX();
+		const int* getY();
+		const int* getZ();
+		int getSets();
+		uint16_t getFirstSet();
+
+		uint32_t getPackets();
+		uint32_t getCRCErrors();
+		uint32_t getSkipped();
+		uint32_t getLostPackets();
+		uint32_t getLostSets();
+
+	private:
+		int parse();
+		bool decode();
+		void drop(int count);
+
+		uint8_t buffer[ACL2_STREAM_PACKET];
+		int have;				//bytes in buffer[]
+		int x[ACL2_STREAM_MAX_SETS];
+		int y[ACL2_STREAM_MAX_SETS];
+		int z[ACL2_STREAM_MAX_SETS];
+		int sets;
+		uint16_t firstSet;
+		bool synced;			//a good packet has been seen, so gaps can be counted
+		uint8_t nextPacket;
+		uint16_t nextSet;
+		uint32_t packets;
+		uint32_t crcErrors;
+		uint32_t skipped;		//bytes thrown away looking for a packet
+		uint32_t lostPackets;
+		uint32_t lostSets;
+};
+
+#endif //ACL2STREAM_H
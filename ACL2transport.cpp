@@ -0,0 +1,299 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2transport.cpp	--	Arduino SPI transport for the ACL2 driver	*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include <ACL2transport.h>
+#include <string.h>
+
+#if ACL2_ARDUINO_SPI
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  ACL2arduinoSPI()
+**
+**  Parameters:
+**    CS - chip select pin, optional
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	default constructor, the chip select pin is set with setChipSelect()
+*/
+ACL2arduinoSPI::ACL2arduinoSPI(){
+
+	chipSelect = SS;
+	clock = ACL2_SPI_CLOCK;
+
+}
+
+ACL2arduinoSPI::ACL2arduinoSPI(int CS){
+
+	chipSelect = CS;
+	clock = ACL2_SPI_CLOCK;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  setChipSelect()
+**
+**  Parameters:
+**    CS - chip select pin
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	sets the pin lowered by select(). Call before begin()
+*/
+void ACL2arduinoSPI::setChipSelect(int CS){
+
+	chipSelect = CS;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  setClock()
+**
+**  Parameters:
+**    hz - SPI clock, the ADXL362 takes up to 8MHz
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	sets the clock select() starts each transaction at. Without SPI transactions
+**		the clock set up by the sketch is used as it is
+*/
+void ACL2arduinoSPI::setClock(uint32_t hz){
+
+	if(hz > 0){
+		clock = hz;
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    bool - always true
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	starts the SPI library and drives chip select high
+*/
+bool ACL2arduinoSPI::begin(){
+
+	SPI.begin();
+	pinMode((uint8_t)chipSelect, OUTPUT);
+	digitalWrite((uint8_t)chipSelect, HIGH);
+
+	return true;
+
+}
+
+/* ------------------------------------------------------------ */
+/*  select()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	starts an SPI transaction, holding off the interrupts registered with
+**		usingInterrupt(), and lowers chip select
+*/
+void ACL2arduinoSPI::select(){
+
+#if defined(SPI_HAS_TRANSACTION)
+	SPI.beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
+#endif
+	digitalWrite((uint8_t)chipSelect, LOW);
+
+}
+
+/* ------------------------------------------------------------ */
+/*  deselect()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	raises chip select and ends the transaction. Transfers are never queued, so
+**		there is nothing to flush
+*/
+void ACL2arduinoSPI::deselect(){
+
+	digitalWrite((uint8_t)chipSelect, HIGH);
+#if defined(SPI_HAS_TRANSACTION)
+	SPI.endTransaction();
+#endif
+
+}
+
+/* ------------------------------------------------------------ */
+/*  transfer()
+**
+**  Parameters:
+**    data - byte to send
+**
+**  Return Value:
+**    uint8_t - byte received
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	clocks one byte
+*/
+uint8_t ACL2arduinoSPI::transfer(uint8_t data){
+
+	return SPI.transfer(data);
+
+}
+
+/* ------------------------------------------------------------ */
+/*  transfer()
+**
+**  Parameters:
+**    tx - bytes to send, 0 to send zeros
+**		rx - buffer for the bytes received, 0 to discard them
+**		count - number of bytes
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	clocks count bytes. With an rx buffer the core's in place block transfer
+**		is used, which keeps the bus busy between bytes; a write only transfer
+**		goes a byte at a time so tx is left untouched
+*/
+void ACL2arduinoSPI::transfer(const uint8_t* tx, uint8_t* rx, int count){
+
+	if(rx != 0){
+		if(tx == 0){
+			memset(rx, 0, count);
+		}
+		else if(tx != rx){
+			memcpy(rx, tx, count);
+		}
+		SPI.transfer(rx, count);
+		return;
+	}
+
+	for(int i = 0; i < count; i ++){
+		SPI.transfer(tx == 0 ? (uint8_t)0 : tx[i]);
+	}
+
+}
+
+/* ------------------------------------------------------------ */
+/*  usingInterrupt()
+**
+**  Parameters:
+**    interruptNumber - external interrupt, as given to attachInterrupt(), whose
+**		handler drains the ACL2
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	registers the interrupt with the SPI library, so every transaction on the bus,
+**		this driver's or another's, holds it off until the transaction ends
+*/
+void ACL2arduinoSPI::usingInterrupt(uint8_t interruptNumber){
+
+#if defined(SPI_HAS_TRANSACTION)
+	SPI.usingInterrupt(interruptNumber);
+#else
+	(void)interruptNumber;
+#endif
+
+}
+
+/* ------------------------------------------------------------ */
+/*  notUsingInterrupt()
+**
+**  Parameters:
+**    interruptNumber - interrupt given to usingInterrupt()
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**   	undoes usingInterrupt() where the SPI library supports it
+*/
+void ACL2arduinoSPI::notUsingInterrupt(uint8_t interruptNumber){
+
+#if defined(SPI_HAS_NOTUSINGINTERRUPT)
+	SPI.notUsingInterrupt(interruptNumber);
+#else
+	(void)interruptNumber;
+#endif
+
+}
+
+#endif //ACL2_ARDUINO_SPI
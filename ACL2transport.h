@@ -0,0 +1,114 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2transport.h	--	SPI transport interface for the ACL2 driver		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Every bus access made by ACL2 goes through an ACL2transport. A		*/
+/*	transaction is select(), any number of transfers, then deselect().	*/
+/*																		*/
+/*	transfer(data) clocks one byte and returns the byte received.		*/
+/*	transfer(tx, rx, count) clocks count bytes full duplex; a null tx	*/
+/*	sends zeros and a null rx discards what comes back, which gives		*/
+/*	the bulk write and bulk read forms. A transport may queue buffer	*/
+/*	transfers until deselect(), so rx is only guaranteed to hold the	*/
+/*	received bytes once deselect() has returned, and tx and rx must		*/
+/*	stay valid until then.												*/
+/*																		*/
+/*	ACL2arduinoSPI drives the Arduino SPI library and a chip select		*/
+/*	pin. It is left out when ACL2_ARDUINO_SPI is 0, e.g. when building	*/
+/*	for Linux with ACL2spidev. Where the core has SPI transactions		*/
+/*	each select() to deselect() is one, at the setClock() rate in SPI	*/
+/*	mode 0, and usingInterrupt() registers the FIFO interrupt so it		*/
+/*	cannot drain in the middle of another library's transaction.		*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2TRANSPORT_H)
+#define ACL2TRANSPORT_H
+
+//build the Arduino SPI backend, set to 0 where there is no SPI library
+#if !defined(ACL2_ARDUINO_SPI)
+#define ACL2_ARDUINO_SPI 1
+#endif
+
+//SPI clock of ACL2arduinoSPI transactions and of checkThroughput() until setSPIClock() is called
+#if !defined(ACL2_SPI_CLOCK)
+#define ACL2_SPI_CLOCK 4000000UL
+#endif
+
+#include "Arduino.h"
+#if ACL2_ARDUINO_SPI
+#include "SPI.h"
+#endif
+
+extern "C" {
+  #include <stdint.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class ACL2transport
+{
+	public:
+		virtual ~ACL2transport() {}
+
+		//prepares the bus, false if it cannot be used
+		virtual bool begin() = 0;
+
+		virtual void select() = 0;
+		virtual void deselect() = 0;
+		virtual uint8_t transfer(uint8_t data) = 0;
+		virtual void transfer(const uint8_t* tx, uint8_t* rx, int count) = 0;
+
+		//interrupt that drains through this transport, for buses shared with other drivers
+		virtual void usingInterrupt(uint8_t interruptNumber) { (void)interruptNumber; }
+		virtual void notUsingInterrupt(uint8_t interruptNumber) { (void)interruptNumber; }
+};
+
+#if ACL2_ARDUINO_SPI
+class ACL2arduinoSPI : public ACL2transport
+{
+	public:
+		ACL2arduinoSPI();
+		ACL2arduinoSPI(int CS);
+
+		void setChipSelect(int CS);
+		void setClock(uint32_t hz);
+
+		bool begin();
+		void select();
+		void deselect();
+		uint8_t transfer(uint8_t data);
+		void transfer(const uint8_t* tx, uint8_t* rx, int count);
+		void usingInterrupt(uint8_t interruptNumber);
+		void notUsingInterrupt(uint8_t interruptNumber);
+
+	private:
+		int chipSelect;
+		uint32_t clock;			//SPI clock of each transaction
+};
+#endif
+
+#endif //ACL2TRANSPORT_H
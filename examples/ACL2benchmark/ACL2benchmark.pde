@@ -0,0 +1,175 @@
+#include <ACL2.h>
+
+/**************************************************/
+/* PmodACL2 Benchmark                             */
+/**************************************************/
+/*    Copyright 2014, Digilent Inc.               */
+/*                                                */
+/*   Made for use with chipKIT Pro MX3            */
+/*   PmodACL2 on connector JC                     */
+/**************************************************/
+/*  Module Description:                           */
+/*                                                */
+/*    This module measures what each public       */
+/*    ACL2 call costs on the SPI bus.             */
+/*                                                */
+/*  Functionality:                                */
+/*                                                */
+/*    Every call is run RUNS times. For each      */
+/*    one a comma separated line is printed with  */
+/*    the average SPI bytes, chip select cycles,  */
+/*    time blocked in delay() and wall time per   */
+/*    call. fillFIFO() and getQueue() are also    */
+/*    reported per 1000 FIFO entries. The counts  */
+/*    do not depend on timing, so the output of   */
+/*    two releases can be diffed directly.        */
+/*                                                */
+/*    The sketch also runs on a PC against the    */
+/*    ADXL362 model in extras/host. There the     */
+/*    wall time is the modelled bus and delay     */
+/*    time only.                                  */
+/*                                                */
+/**************************************************/
+
+// the sensor communicates using SPI, so include the library:
+#include <SPI.h>
+
+const int chipSelectPin = SS;
+const int RUNS = 10;
+
+ACL2 myACL;
+
+ACL2stats stats;
+ACL2stats total;
+unsigned long start;
+unsigned long wall;
+int queue[512];
+
+//clears the library counters and the wall clock
+void resumeMeasure(){
+  myACL.resetStats();
+  start = micros();
+}
+
+//adds everything since resumeMeasure() to the totals
+void pauseMeasure(){
+  wall += micros() - start;
+  myACL.getStats(&stats);
+  total.spiBytes += stats.spiBytes;
+  total.transactions += stats.transactions;
+  total.blockedUs += stats.blockedUs;
+}
+
+void beginMeasure(){
+  total.spiBytes = 0;
+  total.transactions = 0;
+  total.blockedUs = 0;
+  wall = 0;
+  resumeMeasure();
+}
+
+//prints the totals divided by count, multiplied by scale
+void report(const char* name, long count, long scale){
+  if(count < 1){
+    count = 1;
+  }
+
+  Serial.print(name); Serial.print(",");
+  Serial.print(count); Serial.print(",");
+  Serial.print(total.spiBytes * scale / count); Serial.print(",");
+  Serial.print(total.transactions * scale / count); Serial.print(",");
+  Serial.print(total.blockedUs * scale / count); Serial.print(",");
+  Serial.println(wall * scale / count);
+}
+
+void report(const char* name, long count){
+  pauseMeasure();
+  report(name, count, 1);
+}
+
+void setup() {
+  int i = 0;
+  long entries = 0;
+  ACL2sample sample;
+
+  Serial.begin(115200);
+  pinMode(chipSelectPin, OUTPUT);
+
+  Serial.println("call,count,spi_bytes,transactions,blocked_us,wall_us");
+
+  beginMeasure();
+  myACL.begin(chipSelectPin);
+  report("begin", 1);
+
+  beginMeasure();
+  for(i = 0; i < RUNS; i ++){
+    myACL.init();
+  }
+  report("init", RUNS);
+
+  beginMeasure();
+  for(i = 0; i < RUNS; i ++){
+    myACL.getX();
+  }
+  report("getX", RUNS);
+
+  beginMeasure();
+  for(i = 0; i < RUNS; i ++){
+    myACL.getXYZT(&sample);
+  }
+  report("getXYZT", RUNS);
+
+  beginMeasure();
+  for(i = 0; i < RUNS; i ++){
+    myACL.setRange(8);
+  }
+  report("setRange", RUNS);
+
+  beginMeasure();
+  myACL.setZero();
+  report("setZero", 1);
+
+  //let the FIFO collect about a second of data before each drain
+  myACL.initFIFO();
+  myACL.fillFIFO();
+  myACL.xFIFO.resetQueue();
+  myACL.yFIFO.resetQueue();
+  myACL.zFIFO.resetQueue();
+
+  beginMeasure();
+  pauseMeasure();
+  entries = 0;
+  for(i = 0; i < RUNS; i ++){
+    delay(1000);
+    entries += myACL.getFIFOentries();
+    resumeMeasure();
+    myACL.fillFIFO();
+    pauseMeasure();
+    myACL.xFIFO.resetQueue();
+    myACL.yFIFO.resetQueue();
+    myACL.zFIFO.resetQueue();
+  }
+  report("fillFIFO", RUNS, 1);
+  report("fillFIFO/1000 entries", entries, 1000);
+
+  //getQueue() is timed on full queues of 100 entries each
+  beginMeasure();
+  pauseMeasure();
+  for(i = 0; i < RUNS; i ++){
+    for(int j = 0; j < 100; j ++){
+      myACL.xFIFO.push_back(j);
+      myACL.yFIFO.push_back(j);
+      myACL.zFIFO.push_back(j);
+    }
+    resumeMeasure();
+    myACL.xFIFO.getQueue(queue);
+    myACL.yFIFO.getQueue(queue);
+    myACL.zFIFO.getQueue(queue);
+    pauseMeasure();
+  }
+  report("getQueue", 3 * RUNS, 1);
+  report("getQueue/1000 entries", 3 * RUNS * 100, 1000);
+}
+
+void loop() {
+}
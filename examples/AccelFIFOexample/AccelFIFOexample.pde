@@ -18,7 +18,7 @@
 /*                                                */  
 /*    This module initializes the PmodACL2        */
 /*    then reads the x, y, z FIFO buffers         */
-/*    into int arrays then prints them out.       */
+/*    and prints them in place.                   */
 /*    The sample data will be at a 100 kHz        */
 /*    speed. Note the baude rate is 115200        */
 /*                                                */
@@ -44,7 +44,8 @@ ACL2 myACL;
 
 void setup() {
   //baud rate at 115200 to allow 100kHz to be shown.
-  //currently 9600 baud breaks the fifo code
+  //currently 9600 baud breaks the fifo code, AccelFIFOstream sends
+  //the same data in binary at a fraction of the bytes
   Serial.begin(115200);
   int test = 0;
   SPI.begin();// start the SPI library
@@ -61,54 +62,32 @@ void setup() {
   delay(100);
 }
 
-void loop() {
- 
-  
-  //create arrays
-  int xqueue[512];
-  int yqueue[512];
-  int zqueue[512];
+//prints a queue in place through view() and drops what was printed
+void printQueue(const char* name, myQueue& queue){
+  const int* items;
   int length = 0;
   int i = 0;
+
+  Serial.println(name);
+  while((length = queue.view(&items)) > 0){
+    for(i = 0; i < length; i ++){
+      Serial.println(items[i]);
+    }
+    queue.release(length);
+  }
+}
+
+void loop() {
  
  //populate myQueue elements
  myACL.fillFIFO();
  
- //pop myQueues into the user arrays
- length = myACL.xFIFO.size();
- 
- //pass in arrays to fill up
- myACL.xFIFO.getQueue(xqueue);
- myACL.yFIFO.getQueue(yqueue);
- myACL.zFIFO.getQueue(zqueue);
- 
- //print the arrays
- Serial.println("X FIFO: ");
- for(i = 0; i < length; i ++){
-  Serial.println(xqueue[i]);
- }
- 
- Serial.println("Y FIFO: ");
- for(i = 0; i < length; i ++){
-  Serial.println(yqueue[i]);
- }
- 
- Serial.println("Z FIFO: ");
- for(i = 0; i < length; i ++){
-  Serial.println(zqueue[i]);
- }
-  
-
-//reset arrays
-for(i; i < length; i++){
- xqueue[i] = -1;
- yqueue[i] = -1;
- zqueue[i] = -1;
-} 
+ //print the queues without copying them out
+ printQueue("X FIFO: ", myACL.xFIFO);
+ printQueue("Y FIFO: ", myACL.yFIFO);
+ printQueue("Z FIFO: ", myACL.zFIFO);
  
  delay(100);
   
  
 }
-
-
@@ -0,0 +1,80 @@
+#include <ACL2.h>
+
+/**************************************************/
+/* PmodACL2 FIFO Interrupt Demo                   */
+/**************************************************/
+/*    Copyright 2014, Digilent Inc.               */
+/*                                                */
+/*   Made for use with chipKIT Pro MX3            */
+/*   PmodACL2 on connector JC                     */
+/**************************************************/
+/*  Module Description:                           */
+/*                                                */
+/*    This module implements a demo application   */
+/*    of the PmodACL2 FIFO watermark interrupt    */
+/*                                                */
+/*  Functionality:                                */
+/*                                                */
+/*    The ACL2 INT1 pin must be wired to the      */
+/*    external interrupt given by                 */
+/*    interruptNumber. Every time the FIFO holds  */
+/*    150 entries the library drains it into      */
+/*    xFIFO, yFIFO and zFIFO from the interrupt,  */
+/*    so loop() only collects what has arrived    */
+/*    and is free to do other work.               */
+/*                                                */
+/**************************************************/
+
+// the sensor communicates using SPI, so include the library:
+#include <SPI.h>
+
+const int chipSelectPin = SS;
+const int interruptNumber = 0;
+
+ACL2 myACL;
+
+int xqueue[512];
+int yqueue[512];
+int zqueue[512];
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(chipSelectPin, OUTPUT);
+
+  // initialize sensor
+  myACL.begin(chipSelectPin);
+  myACL.initFIFO();
+
+  //interrupt every 50 x, y, z sets (half a second at 100Hz)
+  myACL.setWatermark(150);
+  myACL.beginInterrupt(interruptNumber, 1);
+
+  //share of each half second the bus is free between drains
+  ACL2throughput budget;
+  Serial.print("drain headroom: ");
+  Serial.print(myACL.checkThroughput(&budget));
+  Serial.println("%");
+}
+
+void loop() {
+  int length = 0;
+  int i = 0;
+
+  //take what the interrupt has drained so far, with the interrupt
+  //held off so the three queues stay the same length
+  noInterrupts();
+  length = myACL.xFIFO.size();
+  myACL.xFIFO.getQueue(xqueue);
+  myACL.yFIFO.getQueue(yqueue);
+  myACL.zFIFO.getQueue(zqueue);
+  interrupts();
+
+  for(i = 0; i < length; i ++){
+    Serial.print(xqueue[i]); Serial.print(" ");
+    Serial.print(yqueue[i]); Serial.print(" ");
+    Serial.println(zqueue[i]);
+  }
+
+  //other work goes here
+  delay(200);
+}
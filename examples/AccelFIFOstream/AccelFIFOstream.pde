@@ -0,0 +1,103 @@
+#include <ACL2.h>
+#include <ACL2stream.h>
+
+/**************************************************/
+/* PmodACL2 FIFO Binary Stream Demo               */
+/**************************************************/
+/*    Copyright 2014, Digilent Inc.               */
+/*                                                */
+/*   Made for use with chipKIT Pro MX3            */
+/*   PmodACL2 on connector JC                     */
+/**************************************************/
+/*  Module Description:                           */
+/*                                                */
+/*    This module streams every x, y, z sample    */
+/*    set at 400Hz over the serial port as        */
+/*    ACL2stream packets instead of text          */
+/*                                                */
+/*  Functionality:                                */
+/*                                                */
+/*    Each drain of the FIFO is packed into       */
+/*    packets with a sync word, packet and set    */
+/*    numbers, difference coded varint samples    */
+/*    and a CRC. At rest a set takes about three  */
+/*    bytes, against some fifteen as text, so     */
+/*    400Hz fits easily at 115200 baud. Decode    */
+/*    the output on a PC with                     */
+/*    extras/host/StreamDump.cpp                  */
+/*                                                */
+/*    Every set goes out with its set number, so  */
+/*    sets lost to a FIFO overrun show up as gaps */
+/*    on the PC. Build the library with           */
+/*    -DACL2_FRAME_SEQ=1 (for example in          */
+/*    compiler.cpp.extra_flags) and the numbers   */
+/*    come from seqFIFO; otherwise they are       */
+/*    counted back from getFrameSeq(), which is   */
+/*    exact as long as the queues never fill      */
+/*                                                */
+/**************************************************/
+
+// the sensor communicates using SPI, so include the library:
+#include <SPI.h>
+
+const int chipSelectPin = SS;
+
+ACL2 myACL;
+ACL2streamEncoder stream;
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(chipSelectPin, OUTPUT);
+
+  // initialize sensor
+  myACL.begin(chipSelectPin);
+  myACL.initFIFO();
+  myACL.setDataRate(ODR_400, BANDWIDTH_ODR_4, NOISE_NORMAL);
+}
+
+//sends the packet the encoder has open, if any
+void sendPacket() {
+  int length = stream.finish();
+
+  if(length > 0){
+    Serial.write(stream.getPacket(), length);
+  }
+}
+
+void loop() {
+  int x = 0;
+  int y = 0;
+  int z = 0;
+  uint16_t set = 0;
+
+  myACL.fillFIFO();
+
+#if !ACL2_FRAME_SEQ
+  //the queues are emptied every pass, so the sets in them follow on one from the next
+  set = myACL.getFrameSeq() - myACL.xFIFO.size();
+#endif
+
+  while(myACL.xFIFO.size() > 0){
+    x = myACL.xFIFO.pop_front();
+    y = myACL.yFIFO.pop_front();
+    z = myACL.zFIFO.pop_front();
+#if ACL2_FRAME_SEQ
+    set = myACL.seqFIFO.pop_front();
+#endif
+
+    //a full packet or a gap in the set numbers sends the packet and the set starts the next one
+    if(!stream.add(x, y, z, set)){
+      sendPacket();
+      stream.add(x, y, z, set);
+    }
+
+#if !ACL2_FRAME_SEQ
+    set ++;
+#endif
+  }
+
+  //keep latency to one drain
+  sendPacket();
+
+  delay(100);
+}
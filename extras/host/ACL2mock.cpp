@@ -0,0 +1,122 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2mock.cpp	--	In memory transport for host runs of ACL2		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+
+#include "ACL2mock.h"
+#include "SPI.h"
+#include <string.h>
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+ACL2mock::ACL2mock(SPIhostDevice* device){
+	this->device = device;
+	selected = false;
+	transactions = 0;
+	bytes = 0;
+	logLength = 0;
+	responseLength = 0;
+	responseNext = 0;
+}
+
+void ACL2mock::setDevice(SPIhostDevice* device){
+	this->device = device;
+}
+
+void ACL2mock::setResponse(const uint8_t* bytes, int count){
+	if(count > ACL2MOCK_LOG_SIZE){
+		count = ACL2MOCK_LOG_SIZE;
+	}
+	memcpy(response, bytes, count);
+	responseLength = count;
+	responseNext = 0;
+}
+
+bool ACL2mock::begin(){
+	selected = false;
+	return true;
+}
+
+void ACL2mock::select(){
+	selected = true;
+	transactions ++;
+	if(device != 0){
+		device->select();
+	}
+}
+
+void ACL2mock::deselect(){
+	selected = false;
+	if(device != 0){
+		device->deselect();
+	}
+}
+
+uint8_t ACL2mock::transfer(uint8_t data){
+	return clock(data);
+}
+
+void ACL2mock::transfer(const uint8_t* tx, uint8_t* rx, int count){
+	uint8_t in = 0;
+
+	for(int i = 0; i < count; i ++){
+		in = clock(tx == 0 ? (uint8_t)0 : tx[i]);
+		if(rx != 0){
+			rx[i] = in;
+		}
+	}
+}
+
+const uint8_t* ACL2mock::getLog(){
+	return log;
+}
+
+int ACL2mock::getLogLength(){
+	return logLength;
+}
+
+void ACL2mock::clearLog(){
+	logLength = 0;
+}
+
+bool ACL2mock::isSelected(){
+	return selected;
+}
+
+uint32_t ACL2mock::getTransactions(){
+	return transactions;
+}
+
+uint32_t ACL2mock::getBytes(){
+	return bytes;
+}
+
+/* ------------------------------------------------------------ */
+/*  clock()
+**
+**	logs one byte sent and returns the byte received. Bytes clocked with
+**	chip select high still take bus time but reach no device
+*/
+uint8_t ACL2mock::clock(uint8_t data){
+	hostClockSPI(1);
+	bytes ++;
+	if(logLength < ACL2MOCK_LOG_SIZE){
+		log[logLength ++] = data;
+	}
+
+	if(!selected){
+		return 0;
+	}
+	if(device != 0){
+		return device->transfer(data);
+	}
+	if(responseNext < responseLength){
+		return response[responseNext ++];
+	}
+	return 0;
+}
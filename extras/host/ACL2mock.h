@@ -0,0 +1,80 @@
+/************************************************************************/
+/*																		*/
+/*	ACL2mock.h	--	In memory transport for host runs of ACL2			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	An ACL2transport that never touches SPIClass or a chip select		*/
+/*	pin. Each transaction is passed byte by byte to an SPIhostDevice,	*/
+/*	normally ADXL362sim, with the virtual clock advanced as if the		*/
+/*	bytes were clocked at the hostSetSPIClock() rate. Without a device	*/
+/*	the bytes received come from setResponse() and then read as 0.		*/
+/*																		*/
+/*	The bytes sent are kept in a log so a test can check the exact		*/
+/*	commands the driver issued:											*/
+/*																		*/
+/*	  ACL2mock bus(&sim);												*/
+/*	  myACL.begin(&bus);												*/
+/*	  bus.clearLog();													*/
+/*	  myACL.readRegister(PART_ID);										*/
+/*	  // bus.getLog() holds READ, PART_ID, 0							*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ACL2MOCK_H)
+#define ACL2MOCK_H
+
+#include "ACL2transport.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+//bytes kept by the transmit log and by setResponse()
+const int ACL2MOCK_LOG_SIZE = 1024;
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class SPIhostDevice;
+
+class ACL2mock : public ACL2transport
+{
+	public:
+		ACL2mock(SPIhostDevice* device = 0);
+
+		void setDevice(SPIhostDevice* device);
+		void setResponse(const uint8_t* bytes, int count);
+
+		bool begin();
+		void select();
+		void deselect();
+		uint8_t transfer(uint8_t data);
+		void transfer(const uint8_t* tx, uint8_t* rx, int count);
+
+		const uint8_t* getLog();
+		int getLogLength();
+		void clearLog();
+		bool isSelected();
+		uint32_t getTransactions();
+		uint32_t getBytes();
+
+	private:
+		uint8_t clock(uint8_t data);
+
+		SPIhostDevice* device;
+		bool selected;
+		uint32_t transactions;
+		uint32_t bytes;
+		uint8_t log[ACL2MOCK_LOG_SIZE];
+		int logLength;			//bytes in log[], later bytes are counted but not kept
+		uint8_t response[ACL2MOCK_LOG_SIZE];
+		int responseLength;
+		int responseNext;
+};
+
+#endif //ACL2MOCK_H
@@ -0,0 +1,578 @@
+/************************************************************************/
+/*																		*/
+/*	ADXL362sim.cpp	--	Register level model of the ADXL362			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Register numbers, bit positions and the FIFO entry format follow	*/
+/*	the ADXL362 datasheet. Acceleration is modelled in mg per axis as	*/
+/*	offset + waveform + noise and converted to counts with the range	*/
+/*	set in FILTER_CTL. The sample clock can be offset by a number of	*/
+/*	ppm to model the tolerance of the sensor oscillator				*/
+/*																		*/
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include "ADXL362sim.h"
+
+#include <math.h>
+
+/* ------------------------------------------------------------ */
+/*				Local Definitions								*/
+/* ------------------------------------------------------------ */
+
+#define SIM_READ		0x0B
+#define SIM_WRITE		0x0A
+#define SIM_FIFO_READ	0x0D
+
+#define REG_STATUS			0x0B
+#define REG_FIFO_ENTRIES_L	0x0C
+#define REG_FIFO_ENTRIES_H	0x0D
+#define REG_SOFT_RESET		0x1F
+#define REG_FIFO_CONTROL	0x28
+#define REG_FIFO_SAMPLES	0x29
+#define REG_INTMAP1			0x2A
+#define REG_INTMAP2			0x2B
+#define REG_FILTER_CTL		0x2C
+#define REG_POWER_CTL		0x2D
+
+#define ST_DATA_READY		0x01
+#define ST_FIFO_READY		0x02
+#define ST_FIFO_WATERMARK	0x04
+#define ST_FIFO_OVERRUN		0x08
+#define ST_AWAKE			0x40
+
+//bus is ignored this long after a soft reset
+#define SIM_RESET_NS		500000ULL
+
+//implemented bits of the writable registers 0x20 - 0x2E, the rest read back as 0
+static const uint8_t writeMask[] = {
+	0xFF, 0x07, 0xFF, 0xFF, 0x07, 0xFF, 0xFF, 0x3F,
+	0x0F, 0xFF, 0xFF, 0xFF, 0xDF, 0x7F, 0x01
+};
+
+/* ------------------------------------------------------------ */
+/*  ADXL362sim()
+**
+**  Description:
+**    Constructor. The model starts powered on with all axes at
+**		zero except z, which reads 1 g
+*/
+ADXL362sim::ADXL362sim(){
+	for(int i = 0; i < 3; i ++){
+		shape[i] = SIM_CONSTANT;
+		offset[i] = 0;
+		amplitude[i] = 0;
+		frequency[i] = 0;
+	}
+	offset[2] = 1000;
+	noiseMg = 0;
+	seed = 1;
+	spikeMg = 0;
+	spikeEvery = 0;
+	temperature = 350;
+	clockError = 0;
+	interruptNumber[0] = -1;
+	interruptNumber[1] = -1;
+	intLevel[0] = false;
+	intLevel[1] = false;
+	
+	powerOn();
+}
+
+/* ------------------------------------------------------------ */
+/*  powerOn()
+**
+**  Description:
+**    puts the registers and FIFO in their power on state
+*/
+void ADXL362sim::powerOn(){
+	reset();
+	readyTime = 0;
+	samples = 0;
+	lostEntries = 0;
+}
+
+/* ------------------------------------------------------------ */
+/*  setAxis()
+**
+**  Parameters:
+**    axis - 0, 1 or 2 for x, y or z
+**		shape - SIM_CONSTANT, SIM_SINE or SIM_SQUARE
+**		offset - constant part of the acceleration in mg
+**		amplitude - peak amplitude of the waveform in mg
+**		frequency - waveform frequency in Hz
+*/
+void ADXL362sim::setAxis(int axis, uint8_t newShape, int newOffset, int newAmplitude, int newFrequency){
+	if(axis < 0 || axis > 2){
+		return;
+	}
+	shape[axis] = newShape;
+	offset[axis] = newOffset;
+	amplitude[axis] = newAmplitude;
+	frequency[axis] = newFrequency;
+}
+
+/* ------------------------------------------------------------ */
+/*  setNoise()
+**
+**  Parameters:
+**    mg - approximate standard deviation of the noise added to each axis
+**		newSeed - seed for the noise generator
+*/
+void ADXL362sim::setNoise(int mg, uint32_t newSeed){
+	noiseMg = mg;
+	seed = newSeed ? newSeed : 1;
+}
+
+/* ------------------------------------------------------------ */
+/*  setSpikes()
+**
+**  Parameters:
+**    mg - added to every axis of the spiked conversions
+**		every - spike one conversion in this many, 0 for none
+*/
+void ADXL362sim::setSpikes(int mg, int every){
+	spikeMg = mg;
+	spikeEvery = every;
+}
+
+/* ------------------------------------------------------------ */
+/*  setTemperature()
+**
+**  Parameters:
+**    raw - value reported in TEMP_L/TEMP_H and in temperature FIFO entries
+*/
+void ADXL362sim::setTemperature(int raw){
+	temperature = raw;
+}
+
+/* ------------------------------------------------------------ */
+/*  setClockError()
+**
+**  Parameters:
+**    ppm - deviation of the sample clock from its nominal rate. A positive
+**		value makes the sensor sample slower than the ODR
+*/
+void ADXL362sim::setClockError(long ppm){
+	clockError = ppm;
+}
+
+/* ------------------------------------------------------------ */
+/*  connectInterrupt()
+**
+**  Parameters:
+**    intPin - 1 for INT1, 2 for INT2
+**		number - host interrupt raised on a rising edge of that pin, -1 for none
+*/
+void ADXL362sim::connectInterrupt(int intPin, int number){
+	if(intPin == 1 || intPin == 2){
+		interruptNumber[intPin - 1] = number;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  update()
+**
+**  Description:
+**    produces every sample that is due at the current host time. Called
+**		automatically whenever the device is selected
+*/
+void ADXL362sim::update(){
+	unsigned long long now = (unsigned long long)micros() * 1000;
+	
+	//not measuring, keep the sample clock parked
+	if((regs[REG_POWER_CTL] & 0x03) != 0x02){
+		sampleTime = now + period();
+		return;
+	}
+	
+	while(sampleTime <= now){
+		sample();
+		sampleTime += period();
+	}
+	
+	checkInterrupts();
+}
+
+/* ------------------------------------------------------------ */
+/*  status accessors
+*/
+uint8_t ADXL362sim::getRegister(uint8_t reg){
+	if(reg == REG_FIFO_ENTRIES_L){
+		return fifoCount & 0xFF;
+	}
+	if(reg == REG_FIFO_ENTRIES_H){
+		return (fifoCount >> 8) & 0x03;
+	}
+	return regs[reg & 0x3F];
+}
+
+int ADXL362sim::getFIFOentries(){
+	return fifoCount;
+}
+
+unsigned long ADXL362sim::getSamples(){
+	return samples;
+}
+
+unsigned long ADXL362sim::getLostEntries(){
+	return lostEntries;
+}
+
+bool ADXL362sim::getINT1(){
+	uint8_t map = regs[REG_INTMAP1];
+	
+	update();
+	return ((regs[REG_STATUS] & map & 0x7F) != 0) != ((map & 0x80) != 0);
+}
+
+bool ADXL362sim::getINT2(){
+	uint8_t map = regs[REG_INTMAP2];
+	
+	update();
+	return ((regs[REG_STATUS] & map & 0x7F) != 0) != ((map & 0x80) != 0);
+}
+
+/* ------------------------------------------------------------ */
+/*  SPIhostDevice interface
+*/
+void ADXL362sim::select(){
+	update();
+	command = 0;
+	address = 0;
+	byteCount = 0;
+}
+
+void ADXL362sim::deselect(){
+	byteCount = 0;
+	checkInterrupts();
+}
+
+void ADXL362sim::tick(){
+	update();
+}
+
+uint8_t ADXL362sim::transfer(uint8_t data){
+	uint8_t result = 0;
+	
+	//still coming out of a soft reset, the part does not answer
+	if((unsigned long long)micros() * 1000 < readyTime){
+		byteCount ++;
+		return 0;
+	}
+	
+	if(byteCount == 0){
+		command = data;
+	}
+	else if(command == SIM_FIFO_READ){
+		//entries come out low byte first, one entry per two bytes
+		if(byteCount & 1){
+			fifoEntry = popFIFO();
+			result = fifoEntry & 0xFF;
+		}
+		else{
+			result = fifoEntry >> 8;
+		}
+	}
+	else if(byteCount == 1){
+		address = data & 0x3F;
+	}
+	else if(command == SIM_READ){
+		result = readByte(address);
+		address = (address + 1) & 0x3F;
+	}
+	else if(command == SIM_WRITE){
+		writeByte(address, data);
+		address = (address + 1) & 0x3F;
+	}
+	
+	byteCount ++;
+	return result;
+}
+
+/* ------------------------------------------------------------ */
+/*  reset()
+**
+**  Description:
+**    loads the register reset values and empties the FIFO
+*/
+void ADXL362sim::reset(){
+	for(int i = 0; i < 0x40; i ++){
+		regs[i] = 0;
+	}
+	regs[0x00] = 0xAD;
+	regs[0x01] = 0x1D;
+	regs[0x02] = 0xF2;
+	regs[0x03] = 0x02;
+	regs[REG_STATUS] = ST_AWAKE;
+	regs[REG_FIFO_SAMPLES] = 0x80;
+	regs[REG_FILTER_CTL] = 0x13;
+	
+	fifoHead = 0;
+	fifoCount = 0;
+	command = 0;
+	address = 0;
+	byteCount = 0;
+	fifoEntry = 0;
+	sampleTime = (unsigned long long)micros() * 1000 + period();
+}
+
+/* ------------------------------------------------------------ */
+/*  sample()
+**
+**  Description:
+**    takes one conversion: updates the data registers, DATA_READY and the
+**		FIFO according to the FIFO mode in FIFO_CONTROL
+*/
+void ADXL362sim::sample(){
+	int16_t value[4];
+	uint8_t mode = regs[REG_FIFO_CONTROL] & 0x03;
+	int setSize = (regs[REG_FIFO_CONTROL] & 0x04) ? 4 : 3;
+	
+	for(int i = 0; i < 3; i ++){
+		value[i] = toCounts(axisValue(i));
+	}
+	value[3] = temperature;
+	
+	//data registers hold 12 bit values sign extended to 16 bits
+	for(int i = 0; i < 4; i ++){
+		regs[0x0E + 2 * i] = value[i] & 0xFF;
+		regs[0x0F + 2 * i] = (value[i] >> 8) & 0xFF;
+	}
+	for(int i = 0; i < 3; i ++){
+		regs[0x08 + i] = (value[i] >> 4) & 0xFF;
+	}
+	regs[REG_STATUS] |= ST_DATA_READY;
+	
+	if(mode != 0){
+		if(fifoCount + setSize > SIM_FIFO_SIZE){
+			regs[REG_STATUS] |= ST_FIFO_OVERRUN;
+			
+			//oldest saved mode drops the new set, stream mode drops the oldest
+			if(mode == 1){
+				lostEntries += setSize;
+				setSize = 0;
+			}
+			else{
+				for(int i = 0; i < setSize; i ++){
+					popFIFO();
+					lostEntries ++;
+				}
+			}
+		}
+		
+		//entries carry the axis in bits 15:14 and 14 bits of sign extended data
+		for(int i = 0; i < setSize; i ++){
+			pushFIFO(((uint16_t)i << 14) | (value[i] & 0x3FFF));
+		}
+	}
+	
+	samples ++;
+	updateStatus();
+}
+
+void ADXL362sim::pushFIFO(uint16_t entry){
+	fifo[(fifoHead + fifoCount) % SIM_FIFO_SIZE] = entry;
+	fifoCount ++;
+}
+
+uint16_t ADXL362sim::popFIFO(){
+	uint16_t entry = 0;
+	
+	if(fifoCount > 0){
+		entry = fifo[fifoHead];
+		fifoHead = (fifoHead + 1) % SIM_FIFO_SIZE;
+		fifoCount --;
+		updateStatus();
+	}
+	return entry;
+}
+
+/* ------------------------------------------------------------ */
+/*  axisValue()
+**
+**  Description:
+**    acceleration in mg for one axis at the time of the current sample
+*/
+int ADXL362sim::axisValue(int axis){
+	double t = (double)sampleTime / 1e9;
+	double phase = 2.0 * M_PI * frequency[axis] * t;
+	int result = offset[axis];
+	
+	switch(shape[axis]){
+		case SIM_SINE:
+			result += (int)lround(amplitude[axis] * sin(phase));
+			break;
+		case SIM_SQUARE:
+			result += sin(phase) >= 0 ? amplitude[axis] : -amplitude[axis];
+			break;
+		default:
+			break;
+	}
+	if(spikeEvery > 0 && samples % spikeEvery == (unsigned long)spikeEvery - 1){
+		result += spikeMg;
+	}
+	
+	return result + noise();
+}
+
+/* ------------------------------------------------------------ */
+/*  toCounts()
+**
+**  Description:
+**    converts mg to 12 bit counts at the range set in FILTER_CTL
+*/
+int16_t ADXL362sim::toCounts(int mg){
+	int scale = 1 << ((regs[REG_FILTER_CTL] >> 6) > 2 ? 2 : (regs[REG_FILTER_CTL] >> 6));
+	int counts = mg / scale;
+	
+	if(counts > 2047){
+		counts = 2047;
+	}
+	if(counts < -2048){
+		counts = -2048;
+	}
+	return counts;
+}
+
+/* ------------------------------------------------------------ */
+/*  noise()
+**
+**  Description:
+**    roughly gaussian noise from the sum of four xorshift draws
+*/
+int ADXL362sim::noise(){
+	int sum = 0;
+	
+	if(noiseMg == 0){
+		return 0;
+	}
+	
+	for(int i = 0; i < 4; i ++){
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		sum += (int)(seed % 2001) - 1000;
+	}
+	
+	//four uniform draws of +-1000 have a standard deviation of about 1155
+	return (int)((long)sum * noiseMg / 1155);
+}
+
+/* ------------------------------------------------------------ */
+/*  period()
+**
+**  Description:
+**    sample period in nanoseconds for the ODR in FILTER_CTL
+*/
+unsigned long ADXL362sim::period(){
+	uint8_t odr = regs[REG_FILTER_CTL] & 0x07;
+	unsigned long nominal;
+	
+	//12.5 Hz doubling per step up to 400 Hz
+	if(odr > 5){
+		odr = 5;
+	}
+	nominal = 80000000UL >> odr;
+	
+	return nominal + (long long)nominal * clockError / 1000000;
+}
+
+/* ------------------------------------------------------------ */
+/*  updateStatus()
+**
+**  Description:
+**    recomputes the FIFO bits of the STATUS register
+*/
+void ADXL362sim::updateStatus(){
+	int watermark = regs[REG_FIFO_SAMPLES] | ((regs[REG_FIFO_CONTROL] & 0x08) << 5);
+	
+	regs[REG_STATUS] &= ~(ST_FIFO_READY | ST_FIFO_WATERMARK);
+	if(fifoCount > 0){
+		regs[REG_STATUS] |= ST_FIFO_READY;
+	}
+	if(fifoCount > 0 && fifoCount >= watermark){
+		regs[REG_STATUS] |= ST_FIFO_WATERMARK;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  checkInterrupts()
+**
+**  Description:
+**    tracks the INT1 and INT2 levels and raises the connected host
+**		interrupt on a rising edge
+*/
+void ADXL362sim::checkInterrupts(){
+	for(int i = 0; i < 2; i ++){
+		uint8_t map = regs[REG_INTMAP1 + i];
+		bool level = ((regs[REG_STATUS] & map & 0x7F) != 0) != ((map & 0x80) != 0);
+		bool rising = level && !intLevel[i];
+		
+		//record the level first, the handler may talk to the device
+		intLevel[i] = level;
+		if(rising && interruptNumber[i] >= 0){
+			hostRaiseInterrupt(interruptNumber[i]);
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  readByte()
+**
+**  Description:
+**    register read with the side effects of the part: reading the data
+**		registers clears DATA_READY and reading STATUS clears FIFO_OVERRUN
+*/
+uint8_t ADXL362sim::readByte(uint8_t reg){
+	uint8_t result = getRegister(reg);
+	
+	if(reg == REG_STATUS){
+		regs[REG_STATUS] &= ~ST_FIFO_OVERRUN;
+	}
+	if((reg >= 0x08 && reg <= 0x0A) || (reg >= 0x0E && reg <= 0x15)){
+		regs[REG_STATUS] &= ~ST_DATA_READY;
+	}
+	return result;
+}
+
+/* ------------------------------------------------------------ */
+/*  writeByte()
+**
+**  Description:
+**    register write. Only 0x1F through 0x2E are writable and unused bits
+**		are dropped the way the part drops them
+*/
+void ADXL362sim::writeByte(uint8_t reg, uint8_t value){
+	uint8_t wasMeasuring = (regs[REG_POWER_CTL] & 0x03) == 0x02;
+	
+	if(reg == REG_SOFT_RESET){
+		if(value == 'R'){
+			reset();
+			readyTime = (unsigned long long)micros() * 1000 + SIM_RESET_NS;
+		}
+		return;
+	}
+	if(reg < 0x20 || reg > 0x2E){
+		return;
+	}
+	
+	value &= writeMask[reg - 0x20];
+	regs[reg] = value;
+	
+	if(reg == REG_FIFO_CONTROL && (value & 0x03) == 0){
+		fifoHead = 0;
+		fifoCount = 0;
+	}
+	if(reg == REG_POWER_CTL && !wasMeasuring){
+		sampleTime = (unsigned long long)micros() * 1000 + period();
+	}
+	updateStatus();
+}
@@ -0,0 +1,117 @@
+/************************************************************************/
+/*																		*/
+/*	ADXL362sim.h	--	Register level model of the ADXL362			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Behavioral model of the accelerometer on the PmodACL2. It answers	*/
+/*	the READ, WRITE and FIFO_READ commands, keeps the register map,		*/
+/*	produces samples at the ODR selected in FILTER_CTL and stores them	*/
+/*	in a 512 entry FIFO with the axis tags used by the part. Samples	*/
+/*	are generated from the host clock, so with hostUseVirtualClock()	*/
+/*	every run is repeatable. connectInterrupt() raises a host			*/
+/*	interrupt on the rising edge of INT1 or INT2.						*/
+/*																		*/
+/*	  ADXL362sim sim;													*/
+/*	  hostUseVirtualClock(true);										*/
+/*	  hostAttachDevice(SS, &sim);										*/
+/*	  myACL.begin(SS);													*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ADXL362SIM_H)
+#define ADXL362SIM_H
+
+#include "SPI.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+/*	Waveform shapes for setAxis()
+*/
+const uint8_t SIM_CONSTANT = 0;
+const uint8_t SIM_SINE = 1;
+const uint8_t SIM_SQUARE = 2;
+
+const int SIM_FIFO_SIZE = 512;
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class ADXL362sim : public SPIhostDevice
+{
+	public:
+		ADXL362sim();
+		
+		void powerOn();
+		
+		void setAxis(int axis, uint8_t shape, int offset, int amplitude, int frequency);
+		void setNoise(int mg, uint32_t seed);
+		void setSpikes(int mg, int every);
+		void setTemperature(int raw);
+		void setClockError(long ppm);
+		void connectInterrupt(int intPin, int interruptNumber);
+		
+		void update();
+		
+		uint8_t getRegister(uint8_t address);
+		int getFIFOentries();
+		unsigned long getSamples();
+		unsigned long getLostEntries();
+		bool getINT1();
+		bool getINT2();
+		
+		virtual void select();
+		virtual void deselect();
+		virtual uint8_t transfer(uint8_t data);
+		virtual void tick();
+		
+	private:
+		void reset();
+		void sample();
+		void pushFIFO(uint16_t entry);
+		uint16_t popFIFO();
+		int axisValue(int axis);
+		int16_t toCounts(int mg);
+		int noise();
+		unsigned long period();
+		void updateStatus();
+		void checkInterrupts();
+		uint8_t readByte(uint8_t address);
+		void writeByte(uint8_t address, uint8_t value);
+		
+		uint8_t regs[0x40];
+		uint16_t fifo[SIM_FIFO_SIZE];
+		int fifoHead;
+		int fifoCount;
+		
+		uint8_t command;
+		uint8_t address;
+		int byteCount;
+		uint16_t fifoEntry;
+		
+		uint8_t shape[3];
+		int offset[3];
+		int amplitude[3];
+		int frequency[3];
+		int noiseMg;
+		uint32_t seed;
+		int spikeMg;
+		int spikeEvery;
+		int temperature;
+		long clockError;
+		int interruptNumber[2];
+		bool intLevel[2];
+		
+		unsigned long long readyTime;
+		unsigned long long sampleTime;
+		unsigned long samples;
+		unsigned long lostEntries;
+};
+
+#endif //ADXL362SIM_H
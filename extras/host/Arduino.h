@@ -0,0 +1,126 @@
+/************************************************************************/
+/*																		*/
+/*	Arduino.h	--	Host stand-ins for the Arduino core					*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Provides the small part of the Arduino core used by the ACL2		*/
+/*	library (GPIO, delay and timing) so that ACL2.cpp can be compiled	*/
+/*	unchanged on a Linux host. extras/host/CMakeLists.txt builds		*/
+/*	libACL2.a, the tests in extras/host/tests and the benchmark:		*/
+/*																		*/
+/*	  cmake -S extras/host -B build && cmake --build build				*/
+/*	  ctest --test-dir build											*/
+/*																		*/
+/*	or by hand:															*/
+/*																		*/
+/*	  g++ -c -I extras/host -I . ACL2*.cpp extras/host/ArduinoHost.cpp	*/
+/*	  ar rcs libACL2.a ACL2*.o ArduinoHost.o							*/
+/*																		*/
+/*	Chip select writes are forwarded to the device attached to that		*/
+/*	pin with hostAttachDevice(), see SPI.h								*/
+/*																		*/
+/*	SketchHost.cpp adds a main() that runs an example sketch against	*/
+/*	the ADXL362 model on pin SS, with Serial going to stdout:			*/
+/*																		*/
+/*	  g++ -I extras/host -I . -include Arduino.h -x c++ sketch.pde		*/
+/*	      -x none ACL2*.cpp extras/host/ArduinoHost.cpp				*/
+/*	      extras/host/ADXL362sim.cpp extras/host/SketchHost.cpp -lm		*/
+/*																		*/
+/*	hostUseVirtualClock() replaces the monotonic clock with a virtual	*/
+/*	one that only moves when delay() is called, when SPI bytes are		*/
+/*	clocked (at the rate set by hostSetSPIClock(), or hostClockSPI()	*/
+/*	for transports that bypass SPIClass) or through						*/
+/*	hostAdvanceMicros(). Runs against the ADXL362 model are then		*/
+/*	deterministic														*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(ARDUINO_HOST_H)
+#define ARDUINO_HOST_H
+
+extern "C" {
+  #include <stdint.h>
+  #include <stddef.h>
+}
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define LOW		0
+#define HIGH	1
+
+#define INPUT	0
+#define OUTPUT	1
+
+#define LSBFIRST	0
+#define MSBFIRST	1
+
+#define SS		10
+
+#define CHANGE	1
+#define FALLING	2
+#define RISING	3
+
+#define DEC		10
+#define HEX		16
+#define BIN		2
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class HardwareSerial
+{
+	public:
+		void begin(unsigned long baud);
+		size_t write(uint8_t data);
+		size_t write(const uint8_t* buf, size_t count);
+		size_t print(const char* str);
+		size_t print(char c);
+		size_t print(long value, int base = DEC);
+		size_t print(unsigned long value, int base = DEC);
+		size_t print(int value, int base = DEC);
+		size_t print(unsigned int value, int base = DEC);
+		size_t println();
+		size_t println(const char* str);
+		size_t println(long value, int base = DEC);
+		size_t println(unsigned long value, int base = DEC);
+		size_t println(int value, int base = DEC);
+		size_t println(unsigned int value, int base = DEC);
+};
+
+extern HardwareSerial Serial;
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis();
+unsigned long micros();
+
+void noInterrupts();
+void interrupts();
+void attachInterrupt(uint8_t interruptNumber, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interruptNumber);
+
+void hostUseVirtualClock(bool enable);
+void hostAdvanceMicros(unsigned long us);
+void hostSetSPIClock(unsigned long hz);
+void hostClockSPI(size_t count);
+void hostRaiseInterrupt(uint8_t interruptNumber);
+
+#endif //ARDUINO_HOST_H
@@ -0,0 +1,369 @@
+/************************************************************************/
+/*																		*/
+/*	ArduinoHost.cpp	--	Host implementation of Arduino.h and SPI.h		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	GPIO state is kept in a table, timing uses the monotonic clock		*/
+/*	and SPI transfers go to the device attached to the chip select		*/
+/*	pin that is currently driven low									*/
+/*																		*/
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include "Arduino.h"
+#include "SPI.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+
+#define HOST_PINS		64
+#define HOST_INTERRUPTS	8
+
+SPIClass SPI;
+HardwareSerial Serial;
+
+static uint8_t pinState[HOST_PINS];
+static SPIhostDevice* pinDevice[HOST_PINS];
+static SPIhostDevice* selected = 0;
+
+static void (*interruptHandler[HOST_INTERRUPTS])();
+static int interruptMask = 0;
+static int interruptPending = 0;
+static int spiInterrupts = 0;		//registered with SPI.usingInterrupt()
+static int spiBlocked = 0;			//held off by the open SPI transaction
+static int spiTransactions = 0;
+
+static bool virtualClock = false;
+static unsigned long long virtualNanos = 0;
+static unsigned long spiClock = 4000000;
+
+/* ------------------------------------------------------------ */
+/*  hostNow()
+**
+**  Description:
+**    microseconds elapsed since the first call, on either the virtual
+**		or the monotonic clock
+*/
+static unsigned long long hostNow(){
+	static unsigned long long start = 0;
+	struct timespec ts;
+	unsigned long long now;
+	
+	if(virtualClock){
+		return virtualNanos / 1000;
+	}
+	
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	now = (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+	if(start == 0){
+		start = now;
+	}
+	return now - start;
+}
+
+/* ------------------------------------------------------------ */
+/*  GPIO
+*/
+void pinMode(uint8_t pin, uint8_t mode){
+	(void)pin;
+	(void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+	if(pin >= HOST_PINS){
+		return;
+	}
+	
+	//a falling edge selects the device on this pin, a rising edge releases it
+	if(pinDevice[pin] != 0 && pinState[pin] != value){
+		if(value == LOW){
+			selected = pinDevice[pin];
+			selected->select();
+		}
+		else{
+			pinDevice[pin]->deselect();
+			if(selected == pinDevice[pin]){
+				selected = 0;
+			}
+		}
+	}
+	pinState[pin] = value;
+}
+
+int digitalRead(uint8_t pin){
+	if(pin >= HOST_PINS){
+		return LOW;
+	}
+	return pinState[pin];
+}
+
+/* ------------------------------------------------------------ */
+/*  Timing
+*/
+void delay(unsigned long ms){
+	delayMicroseconds(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us){
+	struct timespec ts;
+	
+	//step the virtual clock so attached devices see time pass
+	if(virtualClock){
+		while(us > 0){
+			unsigned int step = us > 1000 ? 1000 : us;
+			
+			hostAdvanceMicros(step);
+			us -= step;
+			for(int i = 0; i < HOST_PINS; i ++){
+				if(pinDevice[i] != 0){
+					pinDevice[i]->tick();
+				}
+			}
+		}
+		return;
+	}
+	
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000L;
+	nanosleep(&ts, 0);
+}
+
+unsigned long millis(){
+	return (unsigned long)(hostNow() / 1000);
+}
+
+unsigned long micros(){
+	return (unsigned long)hostNow();
+}
+
+/* ------------------------------------------------------------ */
+/*  Interrupts
+**
+**  Handlers run synchronously from hostRaiseInterrupt(). Like an edge
+**		triggered interrupt controller, an interrupt raised while interrupts
+**		are disabled or while a handler runs is latched and serviced later. So is
+**		one registered with SPI.usingInterrupt() while a transaction is open
+*/
+static void runInterrupts(){
+	while(interruptMask == 0 && (interruptPending & ~spiBlocked) != 0){
+		for(int i = 0; i < HOST_INTERRUPTS; i ++){
+			if(interruptPending & ~spiBlocked & (1 << i)){
+				interruptPending &= ~(1 << i);
+				if(interruptHandler[i] != 0){
+					interruptMask ++;
+					interruptHandler[i]();
+					interruptMask --;
+				}
+			}
+		}
+	}
+}
+
+void noInterrupts(){
+	interruptMask ++;
+}
+
+void interrupts(){
+	if(interruptMask > 0){
+		interruptMask --;
+	}
+	runInterrupts();
+}
+
+void attachInterrupt(uint8_t interruptNumber, void (*handler)(), int mode){
+	(void)mode;
+	if(interruptNumber < HOST_INTERRUPTS){
+		interruptHandler[interruptNumber] = handler;
+	}
+}
+
+void detachInterrupt(uint8_t interruptNumber){
+	if(interruptNumber < HOST_INTERRUPTS){
+		interruptHandler[interruptNumber] = 0;
+		interruptPending &= ~(1 << interruptNumber);
+	}
+}
+
+void hostRaiseInterrupt(uint8_t interruptNumber){
+	if(interruptNumber < HOST_INTERRUPTS && interruptHandler[interruptNumber] != 0){
+		interruptPending |= 1 << interruptNumber;
+		runInterrupts();
+	}
+}
+
+void hostUseVirtualClock(bool enable){
+	virtualClock = enable;
+	virtualNanos = 0;
+}
+
+void hostAdvanceMicros(unsigned long us){
+	virtualNanos += (unsigned long long)us * 1000;
+}
+
+void hostSetSPIClock(unsigned long hz){
+	if(hz > 0){
+		spiClock = hz;
+	}
+}
+
+void hostClockSPI(size_t count){
+	//each byte takes 8 SPI clocks of virtual time
+	if(virtualClock){
+		virtualNanos += count * (8000000000ULL / spiClock);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  SPI
+*/
+void hostAttachDevice(uint8_t pin, SPIhostDevice* device){
+	if(pin < HOST_PINS){
+		pinDevice[pin] = device;
+		pinState[pin] = HIGH;
+	}
+}
+
+void SPIClass::begin(){
+}
+
+void SPIClass::end(){
+}
+
+void SPIClass::beginTransaction(SPISettings settings){
+	(void)settings;
+	spiBlocked = spiInterrupts;
+	spiTransactions ++;
+}
+
+void SPIClass::endTransaction(){
+	spiBlocked = 0;
+	runInterrupts();
+}
+
+void SPIClass::usingInterrupt(uint8_t interruptNumber){
+	if(interruptNumber < HOST_INTERRUPTS){
+		spiInterrupts |= 1 << interruptNumber;
+	}
+}
+
+void SPIClass::notUsingInterrupt(uint8_t interruptNumber){
+	if(interruptNumber < HOST_INTERRUPTS){
+		spiInterrupts &= ~(1 << interruptNumber);
+	}
+}
+
+int hostGetSPItransactions(){
+	return spiTransactions;
+}
+
+uint8_t SPIClass::transfer(uint8_t data){
+	hostClockSPI(1);
+	
+	if(selected == 0){
+		return 0;
+	}
+	return selected->transfer(data);
+}
+
+void SPIClass::transfer(void* buf, size_t count){
+	uint8_t* bytes = (uint8_t*)buf;
+	
+	for(size_t i = 0; i < count; i ++){
+		bytes[i] = transfer(bytes[i]);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  Serial, written to stdout
+*/
+void HardwareSerial::begin(unsigned long baud){
+	(void)baud;
+}
+
+size_t HardwareSerial::write(uint8_t data){
+	return fwrite(&data, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t count){
+	return fwrite(buf, 1, count, stdout);
+}
+
+size_t HardwareSerial::print(const char* str){
+	return fputs(str, stdout) < 0 ? 0 : strlen(str);
+}
+
+size_t HardwareSerial::print(char c){
+	return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(unsigned long value, int base){
+	char digits[33];
+	int n = 0;
+	
+	if(base < 2){
+		base = DEC;
+	}
+	do{
+		digits[n++] = "0123456789ABCDEF"[value % base];
+		value /= base;
+	}while(value != 0);
+	
+	for(int i = n - 1; i >= 0; i --){
+		write((uint8_t)digits[i]);
+	}
+	return n;
+}
+
+size_t HardwareSerial::print(long value, int base){
+	if(value < 0 && base == DEC){
+		return print('-') + print((unsigned long)-value, base);
+	}
+	return print((unsigned long)value, base);
+}
+
+size_t HardwareSerial::print(int value, int base){
+	if(base != DEC){
+		return print((unsigned long)(unsigned int)value, base);
+	}
+	return print((long)value, base);
+}
+
+size_t HardwareSerial::print(unsigned int value, int base){
+	return print((unsigned long)value, base);
+}
+
+size_t HardwareSerial::println(){
+	return print('\n');
+}
+
+size_t HardwareSerial::println(const char* str){
+	return print(str) + println();
+}
+
+size_t HardwareSerial::println(long value, int base){
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned long value, int base){
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(int value, int base){
+	return print(value, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned int value, int base){
+	return print(value, base) + println();
+}
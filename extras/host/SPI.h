@@ -0,0 +1,80 @@
+/************************************************************************/
+/*																		*/
+/*	SPI.h	--	Host stand-in for the Arduino SPI library				*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Routes SPI.transfer() to an SPIhostDevice. A device is attached to	*/
+/*	a chip select pin with hostAttachDevice(); digitalWrite() on that	*/
+/*	pin selects and deselects it. With no device selected every			*/
+/*	transfer returns 0. On the virtual clock tick() is called on every	*/
+/*	attached device at least once per millisecond of delay()			*/
+/*																		*/
+/*	Transactions follow the Arduino library: an interrupt registered	*/
+/*	with usingInterrupt() is held off from beginTransaction() to		*/
+/*	endTransaction() and runs once the transaction ends. The clock in	*/
+/*	SPISettings is not modelled, set it with hostSetSPIClock()			*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(SPI_HOST_H)
+#define SPI_HOST_H
+
+#include "Arduino.h"
+
+#define SPI_HAS_TRANSACTION 1
+#define SPI_HAS_NOTUSINGINTERRUPT 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+class SPISettings
+{
+	public:
+		SPISettings() : clock(4000000), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+		SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) :
+			clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+		uint32_t clock;
+		uint8_t bitOrder;
+		uint8_t dataMode;
+};
+
+class SPIhostDevice
+{
+	public:
+		virtual ~SPIhostDevice() {}
+		virtual void select() = 0;
+		virtual void deselect() = 0;
+		virtual uint8_t transfer(uint8_t data) = 0;
+		virtual void tick() {}
+};
+
+class SPIClass
+{
+	public:
+		void begin();
+		void end();
+		void beginTransaction(SPISettings settings);
+		void endTransaction();
+		void usingInterrupt(uint8_t interruptNumber);
+		void notUsingInterrupt(uint8_t interruptNumber);
+		uint8_t transfer(uint8_t data);
+		void transfer(void* buf, size_t count);
+};
+
+extern SPIClass SPI;
+
+void hostAttachDevice(uint8_t pin, SPIhostDevice* device);
+int hostGetSPItransactions();
+
+#endif //SPI_HOST_H
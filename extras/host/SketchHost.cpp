@@ -0,0 +1,53 @@
+/************************************************************************/
+/*																		*/
+/*	SketchHost.cpp	--	Runs an Arduino sketch on the host				*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Provides main() for running a sketch against the ADXL362 model.	*/
+/*	The model is attached to pin SS with INT1 and INT2 wired to		*/
+/*	interrupts 0 and 1, the virtual clock is enabled and				*/
+/*	loop() is called the number of times given on the command line		*/
+/*	(once by default)													*/
+/*																		*/
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include "Arduino.h"
+#include "ADXL362sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void setup();
+void loop();
+
+ADXL362sim hostSensor;
+
+int main(int argc, char** argv){
+	long loops = 1;
+	
+	if(argc > 1){
+		loops = atol(argv[1]);
+	}
+	
+	hostUseVirtualClock(true);
+	hostSensor.powerOn();
+	hostSensor.connectInterrupt(1, 0);
+	hostSensor.connectInterrupt(2, 1);
+	hostAttachDevice(SS, &hostSensor);
+	
+	setup();
+	for(long i = 0; i < loops; i ++){
+		loop();
+	}
+	
+	fflush(stdout);
+	return 0;
+}
@@ -0,0 +1,62 @@
+/************************************************************************/
+/*																		*/
+/*	StreamDump.cpp	--	Decodes an ACL2stream capture on the host		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Reads the bytes sent by the AccelFIFOstream example from a file		*/
+/*	or stdin, e.g. a serial port, and writes one "set,x,y,z" line per	*/
+/*	sample set. Packet, CRC and loss counts go to stderr at the end.	*/
+/*																		*/
+/*	  g++ -I . extras/host/StreamDump.cpp ACL2stream.cpp				*/
+/*	      -o streamdump													*/
+/*	  stty -F /dev/ttyACM0 115200 raw									*/
+/*	  ./streamdump /dev/ttyACM0 > capture.csv							*/
+/*																		*/
+/************************************************************************/
+
+/* ------------------------------------------------------------ */
+/*				Include File Definitions						*/
+/* ------------------------------------------------------------ */
+
+#include "ACL2stream.h"
+
+#include <stdio.h>
+
+int main(int argc, char** argv){
+	FILE* in = stdin;
+	ACL2streamDecoder decoder;
+	int c = 0;
+	int sets = 0;
+	uint16_t set = 0;
+	
+	if(argc > 1){
+		in = fopen(argv[1], "rb");
+		if(in == 0){
+			perror(argv[1]);
+			return 1;
+		}
+	}
+	
+	while((c = fgetc(in)) != EOF){
+		sets = decoder.push((uint8_t)c);
+		set = decoder.getFirstSet();
+		for(int i = 0; i < sets; i ++){
+			printf("%u,%d,%d,%d\n", (uint16_t)(set + i), decoder.getX()[i],
+				decoder.getY()[i], decoder.getZ()[i]);
+		}
+	}
+	
+	fprintf(stderr, "packets %lu crc errors %lu skipped bytes %lu lost packets %lu lost sets %lu\n",
+		(unsigned long)decoder.getPackets(), (unsigned long)decoder.getCRCErrors(),
+		(unsigned long)decoder.getSkipped(), (unsigned long)decoder.getLostPackets(),
+		(unsigned long)decoder.getLostSets());
+	
+	if(in != stdin){
+		fclose(in);
+	}
+	return 0;
+}
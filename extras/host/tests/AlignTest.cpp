@@ -0,0 +1,162 @@
+/************************************************************************/
+/*																		*/
+/*	AlignTest.cpp	--	Sample sets split across drains and resync		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Drains the ADXL362 model seven entries at a time, so nearly every	*/
+/*	chunk ends inside a set, and checks the queues stay the same		*/
+/*	length with each axis holding its own waveform. Then feeds			*/
+/*	drains with scripted axis tags through ACL2mock and checks a set	*/
+/*	broken by an out of order entry is dropped and storage resumes		*/
+/*	at the next x entry													*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2mock.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+#include <stdlib.h>
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+static ADXL362sim sim;
+static ACL2mock bus(&sim);
+static ACL2 acl;
+static ACL2calibration zero;
+
+/*	FIFO entry for axis 0 - 3 (x, y, z, temperature) holding counts
+*/
+static uint16_t entry(int axis, int counts){
+	return ((uint16_t)axis << 14) | (counts & 0x3FFF);
+}
+
+/*	answers one fillFIFO() with STATUS, FIFO_ENTRIES and then the entries given
+*/
+static void script(const uint16_t* entries, int count){
+	uint8_t response[5 + 1 + 2 * 32];
+	int n = 0;
+
+	//READ and STATUS go out before STATUS and FIFO_ENTRIES come back
+	response[n ++] = 0;
+	response[n ++] = 0;
+	response[n ++] = 0;
+	response[n ++] = count & 0xFF;
+	response[n ++] = count >> 8;
+
+	//then FIFO_READ
+	response[n ++] = 0;
+	for(int i = 0; i < count; i ++){
+		response[n ++] = entries[i] & 0xFF;
+		response[n ++] = entries[i] >> 8;
+	}
+	bus.setResponse(response, n);
+	acl.fillFIFO();
+}
+
+/*	true when the next set in the queues is counts x, y, z at 8g
+*/
+static bool nextSet(int x, int y, int z){
+	int gotX = acl.xFIFO.pop_front() - zero.xZero;
+	int gotY = acl.yFIFO.pop_front() - zero.yZero;
+	int gotZ = acl.zFIFO.pop_front() - zero.zZero;
+
+	return gotX == 4 * x && gotY == 4 * y && gotZ == 4 * z;
+}
+
+int main(){
+	int previous = 0;
+	int x = 0;
+	int lowest = 0;
+	int highest = 0;
+	bool lined = true;
+	bool smooth = true;
+	bool even = true;
+
+	hostUseVirtualClock(true);
+	sim.setAxis(0, SIM_SINE, 0, 500, 2);
+	sim.setAxis(1, SIM_CONSTANT, -300, 0, 0);
+	sim.setAxis(2, SIM_CONSTANT, 1000, 0, 0);
+
+	acl.begin(&bus);
+	acl.initFIFO();
+	acl.getCalibration(&zero);
+
+	//one second in chunks of 7 entries, the queues only ever grow by whole sets
+	for(int k = 0; k < 10; k ++){
+		delay(100);
+		acl.startDrain();
+		while(acl.pollDrain(7) > 0){
+			even = even && acl.xFIFO.size() == acl.yFIFO.size();
+			even = even && acl.xFIFO.size() == acl.zFIFO.size();
+		}
+	}
+	CHECK(even);
+	CHECK(acl.xFIFO.size() >= 99 && acl.xFIFO.size() <= 101);
+	CHECK(acl.xFIFO.size() == acl.yFIFO.size() && acl.xFIFO.size() == acl.zFIFO.size());
+
+	//x follows the 2Hz sine, moving at most 63mg a set, and y, z never change
+	previous = acl.xFIFO.front() - zero.xZero;
+	while(acl.xFIFO.size() > 0){
+		x = acl.xFIFO.pop_front() - zero.xZero;
+		smooth = smooth && abs(x - previous) <= 70;
+		lined = lined && acl.yFIFO.pop_front() - zero.yZero == -300;
+		lined = lined && acl.zFIFO.pop_front() - zero.zZero == 1000;
+		lowest = x < lowest ? x : lowest;
+		highest = x > highest ? x : highest;
+		previous = x;
+	}
+	CHECK(smooth);
+	CHECK(lined);
+	CHECK(lowest <= -490 && highest >= 490);
+
+	//from here on the drains see the entries scripted below
+	acl.fillFIFO();
+	acl.xFIFO.empty();
+	acl.yFIFO.empty();
+	acl.zFIFO.empty();
+	bus.setDevice(0);
+
+	//a set missing its z, a y with no x and a z on its own are all dropped
+	const uint16_t broken[] = {
+		entry(0, 1), entry(1, 2), entry(2, 3),
+		entry(0, 4), entry(1, 5),
+		entry(1, 6), entry(2, 7),
+		entry(0, 8), entry(1, 9), entry(2, 10),
+		entry(2, 11),
+		entry(0, 12), entry(1, 13), entry(2, 14)
+	};
+	script(broken, sizeof(broken) / sizeof(broken[0]));
+	CHECK(acl.xFIFO.size() == 3 && acl.zFIFO.size() == 3);
+	CHECK(nextSet(1, 2, 3));
+	CHECK(nextSet(8, 9, 10));
+	CHECK(nextSet(12, 13, 14));
+
+	//a set split between drains is finished by the second one
+	const uint16_t first[] = { entry(0, -1), entry(1, -2) };
+	const uint16_t second[] = { entry(2, -3), entry(0, -4), entry(1, -5), entry(2, -6) };
+	script(first, 2);
+	CHECK(acl.xFIFO.size() == 0);
+	script(second, 4);
+	CHECK(acl.xFIFO.size() == 2 && acl.zFIFO.size() == 2);
+	CHECK(nextSet(-1, -2, -3));
+	CHECK(nextSet(-4, -5, -6));
+
+	//a temperature entry where z belongs breaks the set, the next x starts over
+	const uint16_t stray[] = {
+		entry(0, 20), entry(1, 21), entry(3, 350), entry(2, 22),
+		entry(0, 23), entry(1, 24), entry(2, 25)
+	};
+	script(stray, sizeof(stray) / sizeof(stray[0]));
+	CHECK(acl.xFIFO.size() == 1 && acl.yFIFO.size() == 1 && acl.zFIFO.size() == 1);
+	CHECK(nextSet(23, 24, 25));
+
+	return hostTestResult();
+}
@@ -0,0 +1,76 @@
+/************************************************************************/
+/*																		*/
+/*	BeginTest.cpp	--	Start up and register access on the host		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Brings the driver up against the ADXL362 model, once through		*/
+/*	ACL2mock and once through SPIClass and a chip select pin, and		*/
+/*	checks the commands it sends and the samples it gets back			*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2mock.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+int main(){
+	ADXL362sim sim;
+	ACL2mock bus(&sim);
+	ACL2mock absent;
+	ACL2 acl;
+	ACL2 missing;
+	ACL2 pinned;
+	const uint8_t* log = 0;
+	
+	hostUseVirtualClock(true);
+	
+	//start up polls with a pause between reads instead of spinning on the bus
+	CHECK(acl.begin(&bus));
+	CHECK(acl.getStartupTime() > 0);
+	CHECK(bus.getTransactions() <= 10);
+	
+	bus.clearLog();
+	CHECK(acl.readRegister(PART_ID) == 0xF2);
+	log = bus.getLog();
+	CHECK(bus.getLogLength() == 3);
+	CHECK(log[0] == 0x0B && log[1] == PART_ID && log[2] == 0);
+	CHECK(!bus.isSelected());
+	CHECK(acl.verifyRegisters() == 0);
+	CHECK(sim.getRegister(THRESH_INACT_H) == 0);
+	CHECK(sim.getRegister(INTMAP1) == SET_INACT_INTERUPT);
+	
+	//unused bits read back as 0 and are not a mismatch
+	acl.writeRegister(ACT_INACT_CTL, 0xC0 | ABS_INACT_ENABLE);
+	acl.writeRegister(SELF_TEST, 0xFE);
+	CHECK(sim.getRegister(ACT_INACT_CTL) == ABS_INACT_ENABLE);
+	CHECK(sim.getRegister(SELF_TEST) == 0);
+	CHECK(acl.verifyRegisters() == 0);
+	
+	//a reset behind the driver's back undoes the six registers init() set
+	acl.writeRegister(SOFT_RESET, 'R');
+	delay(1);
+	CHECK(acl.verifyRegisters() == 6);
+	acl.init();
+	CHECK(acl.verifyRegisters() == 0);
+	
+	//nothing answers, so PART_ID never reads 0xF2
+	CHECK(!missing.begin(&absent));
+	CHECK(missing.getStartupTime() == 0);
+	
+	//the same part through SPIClass, 100Hz by default
+	hostAttachDevice(SS, &sim);
+	pinned.begin(SS);
+	CHECK(pinned.getStartupTime() > 0);
+	pinned.initFIFO();
+	delay(100);
+	pinned.fillFIFO();
+	CHECK(pinned.xFIFO.size() >= 9 && pinned.xFIFO.size() <= 11);
+	CHECK(pinned.xFIFO.size() == pinned.zFIFO.size());
+	
+	return hostTestResult();
+}
@@ -0,0 +1,138 @@
+/************************************************************************/
+/*																		*/
+/*	BusTest.cpp	--	ACL2bus drain scheduling							*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Puts two ADXL362 models at different ODRs behind one ACL2bus, plus	*/
+/*	a third that is only checked after notify(). Checks the device		*/
+/*	closest to overrunning is drained first, the drain counts from		*/
+/*	getStatus(), that calling service() well within the budget loses	*/
+/*	nothing and that the notified device is left alone until it is		*/
+/*	notified															*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2bus.h"
+#include "ACL2mock.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+//devices in the order their drains started, repeats of the same device folded
+static int drained[64];
+static int drainCount = 0;
+
+/*	model that notes its id when a FIFO_READ starts
+*/
+class OrderedSim : public ADXL362sim
+{
+	public:
+		OrderedSim(int id){
+			this->id = id;
+			first = false;
+		}
+
+		virtual void select(){
+			first = true;
+			ADXL362sim::select();
+		}
+
+		virtual uint8_t transfer(uint8_t data){
+			if(first && data == FIFO_READ && drainCount < 64 &&
+				(drainCount == 0 || drained[drainCount - 1] != id)){
+				drained[drainCount ++] = id;
+			}
+			first = false;
+			return ADXL362sim::transfer(data);
+		}
+
+	private:
+		int id;
+		bool first;
+};
+
+/*	throws the stored sets away, as an application using them would
+*/
+static void drop(ACL2* acl){
+	acl->xFIFO.empty();
+	acl->yFIFO.empty();
+	acl->zFIFO.empty();
+}
+
+int main(){
+	OrderedSim slowSim(0);
+	OrderedSim fastSim(1);
+	OrderedSim quietSim(2);
+	ACL2mock slowBus(&slowSim);
+	ACL2mock fastBus(&fastSim);
+	ACL2mock quietBus(&quietSim);
+	ACL2 slow;
+	ACL2 fast;
+	ACL2 quiet;
+	ACL2bus rig;
+	ACL2busStatus slowStatus;
+	ACL2busStatus fastStatus;
+	ACL2busStatus quietStatus;
+	ACL2loss loss;
+
+	hostUseVirtualClock(true);
+
+	slow.begin(&slowBus);
+	slow.initFIFO();
+	fast.begin(&fastBus);
+	fast.initFIFO();
+	fast.setDataRate(ODR_400, BANDWIDTH_ODR_4, NOISE_NORMAL);
+	quiet.begin(&quietBus);
+	quiet.initFIFO();
+
+	//the slow device is added first, but the fast one is nearer an overrun
+	CHECK(rig.add(&slow) == 0);
+	CHECK(rig.add(&fast) == 1);
+	CHECK(rig.add(&quiet, true) == 2);
+	delay(300);
+	CHECK(rig.service() == 3);
+	CHECK(drainCount == 3);
+	CHECK(drained[0] == 1 && drained[1] == 0 && drained[2] == 2);
+
+	//five seconds of service() every 20ms. With the 511 entry watermark from
+	//initFIFO() the fast device wants a drain about every 425ms, the slow one every 1.7s
+	rig.resetStatus();
+	for(int k = 0; k < 250; k ++){
+		delay(20);
+		rig.service();
+		drop(&slow);
+		drop(&fast);
+	}
+	rig.getStatus(0, &slowStatus);
+	rig.getStatus(1, &fastStatus);
+	rig.getStatus(2, &quietStatus);
+	CHECK(slowStatus.overruns == 0);
+	CHECK(fastStatus.overruns == 0);
+	CHECK(slowStatus.drains >= 2 && slowStatus.drains <= 4);
+	CHECK(fastStatus.drains >= 3 * slowStatus.drains);
+	CHECK(slowStatus.checks == 250 && fastStatus.checks == 250);
+	fast.getLoss(&loss);
+	CHECK(loss.lostFrames == 0 && loss.queueOverflows == 0);
+
+	//nothing reads the notified device until its interrupt says so
+	CHECK(quietStatus.checks == 0 && quietStatus.drains == 0);
+	rig.notify(2);
+	drainCount = 0;
+	rig.service();
+	rig.getStatus(2, &quietStatus);
+	CHECK(quietStatus.checks == 1 && quietStatus.drains == 1);
+	CHECK(drainCount >= 1 && drained[drainCount - 1] == 2);
+	rig.service();
+	rig.getStatus(2, &quietStatus);
+	CHECK(quietStatus.checks == 1);
+
+	return hostTestResult();
+}
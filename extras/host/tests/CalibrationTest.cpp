@@ -0,0 +1,95 @@
+/************************************************************************/
+/*																		*/
+/*	CalibrationTest.cpp	--	calibrate() and the calibration blob		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Calibrates against an ADXL362 model with known axis offsets, noise	*/
+/*	and spikes, and checks the offsets found undo the model's to		*/
+/*	within the noise. Then saves them with getCalibration() and			*/
+/*	checks setCalibration() loads them on another driver but turns		*/
+/*	down a damaged blob and one saved at another range					*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+#include <stdlib.h>
+
+int main(){
+	ADXL362sim sim;
+	ACL2 acl;
+	ACL2 other;
+	ACL2calibration saved;
+	ACL2calibration blob;
+	ACL2calibration loaded;
+	int kept = 0;
+
+	hostUseVirtualClock(true);
+	hostAttachDevice(SS, &sim);
+	sim.setAxis(0, SIM_CONSTANT, 37, 0, 0);
+	sim.setAxis(1, SIM_CONSTANT, -51, 0, 0);
+	sim.setAxis(2, SIM_CONSTANT, 1012, 0, 0);
+	sim.setNoise(20, 7);
+
+	acl.begin(SS);
+	acl.initFIFO();
+
+	//noise alone averages out to within a few mg, one count is 4mg at 8g
+	kept = acl.calibrate(64);
+	CHECK(kept >= 60 && kept <= 64);
+	acl.getCalibration(&saved);
+	CHECK(abs(saved.xZero + 37) <= 6);
+	CHECK(abs(saved.yZero - 51) <= 6);
+	CHECK(abs(saved.zZero + 12) <= 6);
+
+	//one conversion in 16 is 1.5g off; averaged it would move the offsets by
+	//about 90mg, the median and MAD filter drops it
+	sim.setSpikes(1500, 16);
+	kept = acl.calibrate(64);
+	sim.setSpikes(0, 0);
+	CHECK(kept >= 56 && kept <= 60);
+	acl.getCalibration(&blob);
+	CHECK(abs(blob.xZero + 37) <= 6);
+	CHECK(abs(blob.yZero - 51) <= 6);
+	CHECK(abs(blob.zZero + 12) <= 6);
+
+	//the offsets leave the driver reading 0, 0, 1000 at rest
+	sim.setNoise(0, 7);
+	delay(20);
+	CHECK(abs(acl.getX()) <= 6);
+	CHECK(abs(acl.getY()) <= 6);
+	CHECK(abs(acl.getZ() - 1000) <= 6);
+
+	//a saved blob loads on another driver at the same range
+	other.begin(SS);
+	CHECK(other.setCalibration(&saved));
+	other.getCalibration(&loaded);
+	CHECK(loaded.xZero == saved.xZero);
+	CHECK(loaded.yZero == saved.yZero);
+	CHECK(loaded.zZero == saved.zZero);
+	CHECK(loaded.checksum == saved.checksum);
+
+	//a changed offset breaks the checksum and the offsets stay as they were
+	blob = saved;
+	blob.xZero ++;
+	CHECK(!other.setCalibration(&blob));
+	blob = saved;
+	blob.checksum ^= 0x0100;
+	CHECK(!other.setCalibration(&blob));
+	other.getCalibration(&loaded);
+	CHECK(loaded.xZero == saved.xZero);
+
+	//offsets measured at 8g are not used at 4g
+	other.setRange(4);
+	CHECK(!other.setCalibration(&saved));
+	other.setRange(8);
+	CHECK(other.setCalibration(&saved));
+
+	return hostTestResult();
+}
@@ -0,0 +1,124 @@
+/************************************************************************/
+/*																		*/
+/*	CaptureTest.cpp	--	Double and triple buffered capture				*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Drains the ADXL362 model into ACL2captureBuffers while the			*/
+/*	application holds the front buffer for a slow pass. With two		*/
+/*	buffers the sets past the back buffer are dropped and counted,		*/
+/*	with three the pass fits and swap() hands the buffers out oldest	*/
+/*	first. Built with ACL2_FRAME_SEQ so the frames carry set numbers	*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2capture.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+/*	true when the count frames carry consecutive set numbers from first
+*/
+static bool inSequence(const ACL2frame* frames, int count, uint16_t first){
+	for(int i = 0; i < count; i ++){
+		if(frames[i].seq != (uint16_t)(first + i)){
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(){
+	ADXL362sim sim;
+	ACL2 acl;
+	ACL2loss before;
+	ACL2loss after;
+	static ACL2captureBuffers<20, 2> doubled;
+	static ACL2captureBuffers<20, 3> tripled;
+	uint16_t first = 0;
+	int n = 0;
+
+	hostUseVirtualClock(true);
+	hostAttachDevice(SS, &sim);
+
+	acl.begin(SS);
+	acl.initFIFO();
+	acl.fillFIFO();
+	acl.getLoss(&before);
+
+	//two buffers: a 500ms pass at 100Hz only fits 20 of the 50 sets
+	acl.setCapture(&doubled);
+	delay(500);
+	acl.fillFIFO();
+	acl.getLoss(&after);
+	CHECK(acl.xFIFO.size() == 0);
+	CHECK(doubled.getFrontCount() == 0);
+	CHECK(doubled.getReady() == 0);
+	CHECK(doubled.getDropped() >= 25 && doubled.getDropped() <= 35);
+	CHECK(after.queueOverflows - before.queueOverflows == doubled.getDropped());
+	CHECK(after.overruns == before.overruns);
+
+	n = doubled.swap();
+	CHECK(n == 20);
+	first = doubled.getFront()[0].seq;
+	CHECK(inSequence(doubled.getFront(), n, first));
+
+	//the freed buffer takes the next drain without dropping
+	delay(100);
+	acl.fillFIFO();
+	n = doubled.swap();
+	CHECK(n >= 9 && n <= 11);
+	CHECK((uint16_t)(doubled.getFront()[0].seq - first) > 20);
+	CHECK(after.queueOverflows - before.queueOverflows == doubled.getDropped());
+
+	//three buffers: the same kind of pass fills one and moves on to the next
+	acl.setCapture(&tripled);
+	acl.fillFIFO();
+	tripled.reset();
+	acl.getLoss(&before);
+	CHECK(tripled.swap() == 0);
+	for(int i = 0; i < 3; i ++){
+		delay(100);
+		acl.fillFIFO();
+	}
+	acl.getLoss(&after);
+	CHECK(tripled.getDropped() == 0);
+	CHECK(after.queueOverflows == before.queueOverflows);
+	CHECK(tripled.getReady() == 1);
+
+	//the full buffer comes out before the one the drains were still filling
+	n = tripled.swap();
+	CHECK(n == 20);
+	first = tripled.getFront()[0].seq;
+	CHECK(inSequence(tripled.getFront(), n, first));
+	n = tripled.swap();
+	CHECK(n >= 9 && n <= 11);
+	CHECK(inSequence(tripled.getFront(), n, first + 20));
+	CHECK(tripled.getReady() == 0);
+
+	//temperature goes with the frames while capturing, back to tempFIFO after.
+	//One reading per 4 sets, at most one per drain
+	acl.setTemperatureFIFO(4);
+	for(int i = 0; i < 5; i ++){
+		delay(40);
+		acl.fillFIFO();
+	}
+	CHECK(acl.tempFIFO.size() == 0);
+	CHECK(acl.xFIFO.size() == 0);
+	acl.setCapture(0);
+	for(int i = 0; i < 5; i ++){
+		delay(40);
+		acl.fillFIFO();
+	}
+	CHECK(acl.xFIFO.size() >= 19 && acl.xFIFO.size() <= 21);
+	CHECK(acl.tempFIFO.size() >= 4 && acl.tempFIFO.size() <= 5);
+
+	return hostTestResult();
+}
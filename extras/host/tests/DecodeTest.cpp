@@ -0,0 +1,171 @@
+/************************************************************************/
+/*																		*/
+/*	DecodeTest.cpp	--	Scalar and SIMD FIFO decoders agree				*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	ACL2decodeFIFOsimd() must give exactly what ACL2decodeFIFOscalar()	*/
+/*	gives, counts and every output value, without writing past the		*/
+/*	counts. The streams cover random tags, x, y, z and x, y, z, t sets	*/
+/*	starting at every phase, temperature kept and dropped, corrupted	*/
+/*	tags and unaligned input. CMakeLists.txt also builds this test		*/
+/*	with SSSE3 where the compiler has it, to cover both x86 paths		*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2decode.h"
+#include "HostTest.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------------------------------------ */
+/*					Local Declarations							*/
+/* ------------------------------------------------------------ */
+
+const int MAX_ENTRIES = 600;
+const int16_t UNTOUCHED = 0x5A5A;
+
+static uint8_t buffer[2 * MAX_ENTRIES + 1];
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+static void putEntry(uint8_t* raw, int index, int axis, int value){
+	uint16_t entry = (uint16_t)((axis << 14) | (value & 0x3FFF));
+	
+	raw[2 * index] = entry & 0xFF;
+	raw[2 * index + 1] = entry >> 8;
+}
+
+static int randomValue(){
+	return (rand() % 4096) - 2048;
+}
+
+/*	decodes raw with both decoders and checks they agree
+*/
+static bool compare(const uint8_t* raw, int entries, bool keepTemp){
+	int16_t a[4][MAX_ENTRIES];
+	int16_t b[4][MAX_ENTRIES];
+	ACL2decodeCount countA;
+	ACL2decodeCount countB;
+	bool same = true;
+	
+	for(int i = 0; i < MAX_ENTRIES; i ++){
+		for(int axis = 0; axis < 4; axis ++){
+			a[axis][i] = UNTOUCHED;
+			b[axis][i] = UNTOUCHED;
+		}
+	}
+	
+	ACL2decodeFIFOscalar(raw, entries, a[0], a[1], a[2], keepTemp ? a[3] : 0, &countA);
+	ACL2decodeFIFOsimd(raw, entries, b[0], b[1], b[2], keepTemp ? b[3] : 0, &countB);
+	
+	same = same && countA.x == countB.x && countA.y == countB.y;
+	same = same && countA.z == countB.z && countA.t == countB.t;
+	same = same && countA.x + countA.y + countA.z + countA.t == entries;
+	//whole arrays, so a write past the counts shows up as well
+	same = same && memcmp(a, b, sizeof(a)) == 0;
+	return same;
+}
+
+/*	runs trials of one kind of stream, built by fill(), and reports the first mismatch
+*/
+static void trials(const char* name, int (*fill)(uint8_t* raw)){
+	int failed = 0;
+	
+	for(int trial = 0; trial < 2000; trial ++){
+		//every other trial starts the bytes on an odd address
+		uint8_t* raw = buffer + (trial & 1);
+		int entries = fill(raw);
+		bool keepTemp = (trial & 2) != 0;
+		
+		if(!compare(raw, entries, keepTemp)){
+			if(failed == 0){
+				printf("%s: trial %d, %d entries differ\n", name, trial, entries);
+			}
+			failed ++;
+		}
+	}
+	CHECK(failed == 0);
+}
+
+/*	any tag on any entry
+*/
+static int randomStream(uint8_t* raw){
+	int entries = rand() % MAX_ENTRIES;
+	
+	for(int i = 0; i < entries; i ++){
+		putEntry(raw, i, rand() % 4, randomValue());
+	}
+	return entries;
+}
+
+/*	x, y, z sets or x, y, z, t sets, cut at any point, starting part way into a set
+*/
+static int phaseStream(uint8_t* raw){
+	int setSize = rand() % 2 == 0 ? 3 : 4;
+	int phase = rand() % setSize;
+	int entries = rand() % MAX_ENTRIES;
+	
+	for(int i = 0; i < entries; i ++){
+		putEntry(raw, i, (i + phase) % setSize, randomValue());
+	}
+	return entries;
+}
+
+/*	x, y, z, t sets only, with the temperature range of the part
+*/
+static int temperatureStream(uint8_t* raw){
+	int entries = 4 * (rand() % (MAX_ENTRIES / 4));
+	
+	for(int i = 0; i < entries; i ++){
+		putEntry(raw, i, i % 4, i % 4 == 3 ? 300 + rand() % 600 : randomValue());
+	}
+	return entries;
+}
+
+/*	x, y, z sets with about one tag in twenty replaced, as after a lost byte
+*/
+static int corruptStream(uint8_t* raw){
+	int entries = rand() % MAX_ENTRIES;
+	
+	for(int i = 0; i < entries; i ++){
+		putEntry(raw, i, rand() % 20 == 0 ? rand() % 4 : i % 3, randomValue());
+	}
+	return entries;
+}
+
+int main(){
+	uint8_t raw[8];
+	int16_t x[4];
+	int16_t y[4];
+	int16_t z[4];
+	int16_t t[4];
+	ACL2decodeCount count;
+	
+	srand(11);
+	
+	//values are sign extended from bit 13 and land in the output of their tag
+	putEntry(raw, 0, 0, -1);
+	putEntry(raw, 1, 1, 2047);
+	putEntry(raw, 2, 2, -2048);
+	putEntry(raw, 3, 3, 512);
+	ACL2decodeFIFOscalar(raw, 4, x, y, z, t, &count);
+	CHECK(count.x == 1 && count.y == 1 && count.z == 1 && count.t == 1);
+	CHECK(x[0] == -1 && y[0] == 2047 && z[0] == -2048 && t[0] == 512);
+	
+	trials("random", randomStream);
+	trials("phase", phaseStream);
+	trials("temperature", temperatureStream);
+	trials("corrupt", corruptStream);
+	
+	//nothing to decode
+	CHECK(compare(buffer, 0, true));
+	
+	return hostTestResult();
+}
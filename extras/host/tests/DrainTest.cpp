@@ -0,0 +1,146 @@
+/************************************************************************/
+/*																		*/
+/*	DrainTest.cpp	--	Incremental drains with startDrain()			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Empties a nearly full ADXL362 model in pollDrain() chunks through	*/
+/*	ACL2mock, checking that every call is one FIFO_READ transaction		*/
+/*	and that the remainder only goes down. Then cuts drains short		*/
+/*	with fillFIFO(), serviceInterrupt() and initFIFO() and checks		*/
+/*	that no set is lost, stored twice or stored out of line				*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2mock.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+static ADXL362sim sim;
+static ACL2mock bus(&sim);
+static ACL2 acl;
+
+/*	empties the queues and returns how many sets they held, or -1 if a set
+**	does not hold the axis offsets the model was given
+*/
+static int takeSets(){
+	ACL2calibration zero;
+	int sets = acl.xFIFO.size();
+	int x = 0;
+	int y = 0;
+	int z = 0;
+
+	acl.getCalibration(&zero);
+	if(acl.yFIFO.size() != sets || acl.zFIFO.size() != sets){
+		sets = -1;
+	}
+	while(acl.xFIFO.size() > 0 || acl.yFIFO.size() > 0 || acl.zFIFO.size() > 0){
+		x = acl.xFIFO.pop_front() - zero.xZero;
+		y = acl.yFIFO.pop_front() - zero.yZero;
+		z = acl.zFIFO.pop_front() - zero.zZero;
+		if(x != 100 || y != -200 || z != 1000){
+			sets = -1;
+		}
+	}
+	return sets;
+}
+
+/*	starts a drain, reads entries of it with pollDrain() and lets finish()
+**	close it. Checks every set the model made since the FIFO was last empty
+**	is stored once
+*/
+static void cutShort(int entries, void (*finish)()){
+	unsigned long made = 0;
+
+	acl.fillFIFO();
+	takeSets();
+	made = sim.getSamples();
+
+	delay(1000);
+	CHECK(acl.startDrain() >= 300);
+	CHECK(acl.pollDrain(entries) > 0);
+	CHECK(acl.isDraining());
+	finish();
+	CHECK(!acl.isDraining());
+	CHECK(acl.pollDrain() == 0);
+	CHECK(sim.getFIFOentries() == 0);
+	CHECK(takeSets() == (int)(sim.getSamples() - made));
+}
+
+static void finishByFill(){
+	acl.fillFIFO();
+}
+
+static void finishByInterrupt(){
+	acl.serviceInterrupt();
+}
+
+int main(){
+	uint32_t transactions = 0;
+	int remaining = 0;
+	int previous = 0;
+	int sets = 0;
+
+	hostUseVirtualClock(true);
+	sim.setAxis(0, SIM_CONSTANT, 100, 0, 0);
+	sim.setAxis(1, SIM_CONSTANT, -200, 0, 0);
+	sim.setAxis(2, SIM_CONSTANT, 1000, 0, 0);
+
+	acl.begin(&bus);
+	acl.initFIFO();
+
+	//nothing to do without a drain
+	CHECK(acl.pollDrain(32) == 0);
+
+	//165 sets leave the FIFO just short of an overrun
+	delay(1650);
+	previous = acl.startDrain();
+	CHECK(previous == 495);
+	CHECK(acl.isDraining());
+
+	//each call is one FIFO_READ of at most 32 entries and the remainder only goes down
+	while(previous > 0){
+		transactions = bus.getTransactions();
+		bus.clearLog();
+		remaining = acl.pollDrain(32);
+		CHECK(bus.getTransactions() == transactions + 1);
+		CHECK(bus.getLog()[0] == FIFO_READ);
+		CHECK(bus.getLogLength() <= 1 + 2 * 32);
+		CHECK(remaining < previous);
+		previous = remaining;
+	}
+	CHECK(!acl.isDraining());
+	sets = takeSets();
+	CHECK(sets == 165);
+
+	//a full drain in the middle picks up where the chunks stopped, mid set or not
+	cutShort(30, finishByFill);
+	cutShort(31, finishByFill);
+	cutShort(32, finishByInterrupt);
+	cutShort(7, finishByInterrupt);
+
+	//initFIFO() abandons the drain, later sets still line up
+	acl.fillFIFO();
+	takeSets();
+	delay(500);
+	acl.startDrain();
+	acl.pollDrain(31);
+	acl.initFIFO();
+	CHECK(!acl.isDraining());
+	CHECK(acl.pollDrain() == 0);
+	takeSets();
+	delay(500);
+	acl.fillFIFO();
+	sets = takeSets();
+	CHECK(sets >= 49);
+
+	return hostTestResult();
+}
@@ -0,0 +1,49 @@
+/************************************************************************/
+/*																		*/
+/*	HostTest.h	--	Checks shared by the host tests						*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Each test is its own program, run by ctest from the build set up	*/
+/*	by extras/host/CMakeLists.txt. CHECK() prints the failed condition	*/
+/*	with its line and counts it; main() returns hostTestResult(),		*/
+/*	which is non zero if any check failed.								*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(HOST_TEST_H)
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define CHECK(condition)	hostCheck((condition), #condition, __FILE__, __LINE__)
+
+static int hostChecks = 0;
+static int hostFailures = 0;
+
+/* ------------------------------------------------------------ */
+/*					Procedure Definitions						*/
+/* ------------------------------------------------------------ */
+
+static inline bool hostCheck(bool passed, const char* condition, const char* file, int line){
+	hostChecks ++;
+	if(!passed){
+		hostFailures ++;
+		printf("%s:%d: CHECK(%s) failed\n", file, line, condition);
+	}
+	return passed;
+}
+
+static inline int hostTestResult(){
+	printf("%d checks, %d failed\n", hostChecks, hostFailures);
+	return hostFailures == 0 ? 0 : 1;
+}
+
+#endif //HOST_TEST_H
@@ -0,0 +1,167 @@
+/************************************************************************/
+/*																		*/
+/*	LossTest.cpp	--	Overrun accounting and the drain budget			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Lets the ADXL362 model overrun and compares the sets getLoss()		*/
+/*	estimates were lost with the entries the model really dropped,		*/
+/*	with x, y, z sets, with temperature in the FIFO and through			*/
+/*	ACL2bus. Then compares the bus cost checkThroughput() predicts		*/
+/*	for a drain with what getStats() counts for one					*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2bus.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+#include <stdlib.h>
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+static ADXL362sim sim;
+
+/*	throws the stored sets away so the queues never fill
+*/
+static void drop(ACL2* acl){
+	acl->xFIFO.empty();
+	acl->yFIFO.empty();
+	acl->zFIFO.empty();
+	acl->tempFIFO.empty();
+}
+
+/*	drains at 400Hz with gaps that overrun the FIFO and checks the estimate is
+**	within a set per overrun of what the model lost. decimation as for
+**	setTemperatureFIFO(), bus to drain through ACL2bus instead of fillFIFO()
+*/
+static void overruns(int decimation, bool bus){
+	ACL2 acl;
+	ACL2bus rig;
+	ACL2loss loss;
+	unsigned long lostBefore = 0;
+	long simLost = 0;
+	int setSize = decimation == 1 ? 4 : 3;
+	
+	acl.begin(SS);
+	acl.initFIFO();
+	acl.setDataRate(ODR_400, BANDWIDTH_ODR_4, NOISE_NORMAL);
+	acl.setTemperatureFIFO(decimation);
+	if(bus){
+		rig.add(&acl);
+	}
+	
+	acl.fillFIFO();
+	acl.resetLoss();
+	lostBefore = sim.getLostEntries();
+	for(int k = 0; k < 12; k ++){
+		//every third gap is long enough to overrun
+		delay(k % 3 == 2 ? 1500 : 300);
+		if(bus){
+			rig.service();
+		}
+		else{
+			acl.fillFIFO();
+		}
+		drop(&acl);
+	}
+	
+	acl.getLoss(&loss);
+	simLost = (sim.getLostEntries() - lostBefore) / setSize;
+	printf("decimation %d%s: %lu overruns, %lu sets lost, model lost %ld\n", decimation,
+		bus ? " via ACL2bus" : "", (unsigned long)loss.overruns, (unsigned long)loss.lostFrames, simLost);
+	CHECK(loss.overruns == 4);
+	CHECK(labs((long)loss.lostFrames - simLost) <= (long)loss.overruns);
+	CHECK(loss.queueOverflows == 0);
+}
+
+/*	one drain of the entries checkThroughput() expects, counted with getStats()
+*/
+static void budget(bool watermark, int decimation){
+	ACL2 acl;
+	ACL2throughput estimate;
+	ACL2stats stats;
+	uint32_t predicted = 0;
+	
+	acl.begin(SS);
+	acl.initFIFO();
+	acl.setDataRate(ODR_400, BANDWIDTH_ODR_4, NOISE_NORMAL);
+	acl.setTemperatureFIFO(decimation);
+	if(watermark){
+		acl.setWatermark(150);
+		acl.beginInterrupt(0, 1);
+		sim.connectInterrupt(1, 0);
+	}
+	acl.fillFIFO();
+	
+	acl.resetStats();
+	if(watermark){
+		//the interrupt drains as soon as the watermark is reached
+		delay(150 / 3 * 2500 / 1000 + 1);
+	}
+	else{
+		//the drain after the count of sets since the last temperature reading runs out
+		delay(100);
+		acl.fillFIFO();
+		acl.resetStats();
+		drop(&acl);
+		//poll when the FIFO is full
+		delay(2000);
+		acl.fillFIFO();
+	}
+	acl.getStats(&stats);
+	acl.checkThroughput(&estimate);
+	if(watermark){
+		acl.endInterrupt();
+		sim.connectInterrupt(1, -1);
+	}
+	
+	//ACL2_TRANSACTION_US covers chip select, which the host does not time
+	predicted = stats.spiBytes * 8000 / (ACL2_SPI_CLOCK / 1000) + stats.transactions * ACL2_TRANSACTION_US;
+	printf("%s, decimation %d: %u entries, estimated %lu us, counted %lu bytes %lu transactions, %lu us\n",
+		watermark ? "watermark" : "polling", decimation, estimate.entries, (unsigned long)estimate.drainUs,
+		(unsigned long)stats.spiBytes, (unsigned long)stats.transactions, (unsigned long)stats.drainUsMax);
+	CHECK(stats.drains == 1);
+	CHECK(stats.maxEntries == estimate.entries);
+	CHECK(estimate.drainUs == predicted);
+	CHECK(stats.drainUsMax <= estimate.drainUs);
+	CHECK(estimate.headroom > 0);
+}
+
+int main(){
+	ACL2 acl;
+	ACL2throughput estimate;
+	
+	hostUseVirtualClock(true);
+	hostAttachDevice(SS, &sim);
+	
+	overruns(0, false);
+	overruns(1, false);
+	overruns(0, true);
+	
+	budget(false, 0);
+	budget(true, 0);
+	budget(false, 1);
+	budget(false, 8);
+	
+	//a watermark 12 entries short of full leaves 10ms to drain 500 entries at 400Hz,
+	//which 4MHz manages and 400kHz does not
+	acl.begin(SS);
+	acl.initFIFO();
+	acl.setDataRate(ODR_400, BANDWIDTH_ODR_4, NOISE_NORMAL);
+	acl.setWatermark(500);
+	acl.beginInterrupt(0, 1);
+	CHECK(acl.checkThroughput(&estimate) > 0);
+	CHECK(estimate.marginUs == 10000);
+	acl.setSPIClock(400000);
+	CHECK(acl.checkThroughput(&estimate) < 0);
+	acl.endInterrupt();
+	
+	return hostTestResult();
+}
@@ -0,0 +1,93 @@
+/************************************************************************/
+/*																		*/
+/*	RingTest.cpp	--	ACL2ring indexes, wrapping and zero copy reads	*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Fills an ACL2ring past the end of its buffer and reads it back		*/
+/*	through view() and release(): the data comes out as two				*/
+/*	contiguous spans, release() moves the head by exactly what was		*/
+/*	used, and the free running indexes survive wrapping past 65535		*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2ring.h"
+#include "HostTest.h"
+
+int main(){
+	ACL2ring<int, 8> ring;
+	const int* items = 0;
+	int values[8];
+	int n = 0;
+	bool whole = true;
+
+	//empty: nothing to view and release() has nothing to drop
+	CHECK(ring.view(&items) == 0);
+	ring.release(3);
+	CHECK(ring.size() == 0);
+
+	//head and tail at 6, then 5 items land in slots 6, 7, 0, 1, 2
+	for(int i = 0; i < 6; i ++){
+		ring.push_back(i);
+	}
+	ring.release(6);
+	CHECK(ring.size() == 0);
+	for(int i = 0; i < 5; i ++){
+		values[i] = 100 + i;
+	}
+	CHECK(ring.push(values, 5) == 5);
+	CHECK(ring.size() == 5);
+
+	//first span runs to the end of the buffer
+	n = ring.view(&items);
+	CHECK(n == 2);
+	CHECK(items[0] == 100 && items[1] == 101);
+
+	//part of a span: the head moves by one and the view follows it
+	ring.release(1);
+	CHECK(ring.size() == 4);
+	n = ring.view(&items);
+	CHECK(n == 1 && items[0] == 101);
+	ring.release(n);
+
+	//second span starts at slot 0
+	n = ring.view(&items);
+	CHECK(n == 3);
+	CHECK(items[0] == 102 && items[1] == 103 && items[2] == 104);
+	CHECK(ring.front() == 102 && ring.back() == 104);
+
+	//releasing more than there is only empties the ring
+	ring.release(10);
+	CHECK(ring.size() == 0);
+	CHECK(ring.view(&items) == 0);
+
+	//full ring refuses more and counts it
+	for(int i = 0; i < 10; i ++){
+		ring.push_back(200 + i);
+	}
+	CHECK(ring.size() == 8);
+	CHECK(ring.overflows() == 2);
+	n = ring.view(&items);
+	CHECK(n == 5 && items[0] == 200);
+	ring.release(n);
+	n = ring.view(&items);
+	CHECK(n == 3 && items[0] == 205 && items[2] == 207);
+	ring.release(n);
+
+	//the 16 bit indexes wrap many times over, the order holds
+	for(int i = 0; i < 70000; i ++){
+		ring.push_back(i);
+		ring.push_back(i + 1);
+		whole = whole && ring.pop_front() == i;
+		n = ring.view(&items);
+		whole = whole && n == 1 && items[0] == i + 1;
+		ring.release(n);
+	}
+	CHECK(whole);
+	CHECK(ring.size() == 0);
+
+	return hostTestResult();
+}
@@ -0,0 +1,202 @@
+/************************************************************************/
+/*																		*/
+/*	SpidevTest.cpp	--	ACL2spidev against a stand-in spidev node		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Defines open(), ioctl() and close() for one made up device node	*/
+/*	so ACL2spidev runs without a kernel driver. Each SPI_IOC_MESSAGE	*/
+/*	is played to the ADXL362 model, with chip select left low when		*/
+/*	the last transfer has cs_change set, as spidev does. Checks a		*/
+/*	transaction goes out as one message, that a full batch and			*/
+/*	transfer(data) send early with chip select held, and that a		*/
+/*	failed ioctl is reported. Linux only								*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2spidev.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------ */
+/*					Local Variables								*/
+/* ------------------------------------------------------------ */
+
+static const char* node = "/dev/spidev-test";
+static const int nodeFd = 1000;
+
+static ADXL362sim sim;
+static bool selected = false;	//chip select of the model
+static int failNext = 0;		//errno for the next SPI_IOC_MESSAGE, 0 to succeed
+static uint32_t speed = 0;		//from SPI_IOC_WR_MAX_SPEED_HZ
+
+//transfers in each message and whether any but the last had cs_change set
+static int sizes[64];
+static bool midChange[64];
+static int messages = 0;
+
+/* ------------------------------------------------------------ */
+/*					Stand-in System Calls						*/
+/* ------------------------------------------------------------ */
+
+extern "C" int open(const char* path, int flags, ...){
+	va_list args;
+	int mode = 0;
+
+	if(strcmp(path, node) == 0){
+		return nodeFd;
+	}
+	va_start(args, flags);
+	mode = va_arg(args, int);
+	va_end(args);
+	return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+extern "C" int close(int fd){
+	if(fd == nodeFd){
+		return 0;
+	}
+	return syscall(SYS_close, fd);
+}
+
+extern "C" int ioctl(int fd, unsigned long request, ...){
+	va_list args;
+	void* arg = 0;
+	struct spi_ioc_transfer* xfer = 0;
+	int count = 0;
+
+	va_start(args, request);
+	arg = va_arg(args, void*);
+	va_end(args);
+
+	if(fd != nodeFd){
+		return syscall(SYS_ioctl, fd, request, arg);
+	}
+	if(request == SPI_IOC_WR_MAX_SPEED_HZ){
+		speed = *(uint32_t*)arg;
+	}
+	if(_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0 || _IOC_DIR(request) != _IOC_WRITE){
+		return 0;
+	}
+	if(failNext != 0){
+		errno = failNext;
+		failNext = 0;
+		return -1;
+	}
+
+	xfer = (struct spi_ioc_transfer*)arg;
+	count = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+	if(messages < 64){
+		sizes[messages] = count;
+		midChange[messages] = false;
+		for(int i = 0; i < count - 1; i ++){
+			midChange[messages] = midChange[messages] || xfer[i].cs_change;
+		}
+	}
+	messages ++;
+
+	if(!selected){
+		sim.select();
+		selected = true;
+	}
+	for(int i = 0; i < count; i ++){
+		for(uint32_t j = 0; j < xfer[i].len; j ++){
+			uint8_t out = xfer[i].tx_buf ? ((uint8_t*)(uintptr_t)xfer[i].tx_buf)[j] : 0;
+			uint8_t in = sim.transfer(out);
+			hostClockSPI(1);
+			if(xfer[i].rx_buf){
+				((uint8_t*)(uintptr_t)xfer[i].rx_buf)[j] = in;
+			}
+		}
+	}
+	if(count == 0 || !xfer[count - 1].cs_change){
+		sim.deselect();
+		selected = false;
+	}
+	return count;
+}
+
+int main(){
+	ACL2spidev bus(node, 4000000UL);
+	ACL2spidev missing("/nonexistent/spidev");
+	ACL2 acl;
+	uint8_t command[2] = { READ, 0x00 };
+	uint8_t id[8];
+	int first = 0;
+	int sets = 0;
+
+	hostUseVirtualClock(true);
+
+	CHECK(!missing.begin());
+	CHECK(missing.getError() == ENOENT);
+
+	CHECK(acl.begin(&bus));
+	CHECK(bus.getError() == 0);
+	CHECK(speed == 4000000UL);
+
+	//a register read is one message, chip select released at the end
+	first = messages;
+	CHECK(acl.readRegister(PART_ID) == ADXL362_PART_ID);
+	CHECK(messages == first + 1);
+	CHECK(!selected && !midChange[first]);
+
+	//a drain is one message for STATUS and one per ACL2_DRAIN_CHUNK entries
+	acl.initFIFO();
+	delay(1000);
+	first = messages;
+	acl.fillFIFO();
+	sets = acl.xFIFO.size();
+	CHECK(sets >= 99 && sets <= 101);
+	CHECK(messages - first == 1 + (3 * sets + ACL2_DRAIN_CHUNK - 1) / ACL2_DRAIN_CHUNK);
+	CHECK(!selected);
+
+	//more transfers than a batch holds: the first message keeps chip select low
+	first = messages;
+	bus.select();
+	bus.transfer(&command[0], 0, 1);
+	bus.transfer(&command[1], 0, 1);
+	for(int i = 0; i < 8; i ++){
+		bus.transfer(0, &id[i], 1);
+	}
+	CHECK(messages == first + 1);
+	CHECK(selected);
+	bus.deselect();
+	CHECK(!selected);
+	CHECK(messages == first + 2);
+	CHECK(sizes[first] == ACL2_SPIDEV_BATCH && sizes[first + 1] == 10 - ACL2_SPIDEV_BATCH);
+	CHECK(!midChange[first] && !midChange[first + 1]);
+	CHECK(id[0] == 0xAD && id[1] == 0x1D && id[2] == ADXL362_PART_ID);
+
+	//transfer(data) sends at once and holds chip select, release sends an empty transfer
+	first = messages;
+	bus.select();
+	bus.transfer(READ);
+	bus.transfer(PART_ID);
+	CHECK(bus.transfer(0) == ADXL362_PART_ID);
+	CHECK(selected);
+	bus.deselect();
+	CHECK(!selected);
+	CHECK(messages == first + 4);
+	CHECK(sizes[first + 3] == 1);
+	CHECK(bus.getMessages() == (uint32_t)messages);
+
+	//a failed message reads as zeros and leaves its errno
+	failNext = EIO;
+	CHECK(acl.readRegister(PART_ID) == 0);
+	CHECK(bus.getError() == EIO);
+	CHECK(acl.readRegister(PART_ID) == ADXL362_PART_ID);
+
+	bus.end();
+	return hostTestResult();
+}
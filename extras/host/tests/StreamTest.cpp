@@ -0,0 +1,153 @@
+/************************************************************************/
+/*																		*/
+/*	StreamTest.cpp	--	ACL2stream round trip, clean and corrupted		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Encodes sample sets into packets and feeds the bytes to the			*/
+/*	decoder, first as they are and then with bits flipped, bytes		*/
+/*	dropped and noise added. Every set that comes out must be the one	*/
+/*	sent under that set number, and packets that do not come out must	*/
+/*	be counted as lost													*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2stream.h"
+#include "HostTest.h"
+
+#include <stdlib.h>
+
+/* ------------------------------------------------------------ */
+/*					Local Declarations							*/
+/* ------------------------------------------------------------ */
+
+const int SETS = 70000;			//enough for the set numbers to wrap
+
+static int sentX[SETS];
+static int sentY[SETS];
+static int sentZ[SETS];
+
+static ACL2streamEncoder encoder;
+static ACL2streamDecoder decoder;
+static int received = 0;
+static int wrong = 0;
+static int sent = 0;
+static int packets = 0;
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+/*	hands one byte to the decoder and checks the sets of a packet it completes.
+**	Set numbers are 16 bits, so the set sent is found from the low bits
+*/
+static void receive(uint8_t data, int near){
+	int sets = decoder.push(data);
+	
+	for(int j = 0; j < sets; j ++){
+		int index = near - (uint16_t)(near - (decoder.getFirstSet() + j));
+		
+		if(index < 0 || index >= SETS || decoder.getX()[j] != sentX[index] ||
+				decoder.getY()[j] != sentY[index] || decoder.getZ()[j] != sentZ[index]){
+			wrong ++;
+		}
+		received ++;
+	}
+}
+
+/*	closes the open packet and passes it on. Each of the three kinds of damage hits
+**	about one packet in damage
+*/
+static void send(int damage, int near){
+	int length = encoder.finish();
+	const uint8_t* packet = encoder.getPacket();
+	
+	if(length == 0){
+		return;
+	}
+	packets ++;
+	
+	for(int k = 0; k < length; k ++){
+		int roll = damage > 0 ? rand() % (damage * length) : 1;
+		
+		if(roll == 0){
+			//a flipped bit
+			receive(packet[k] ^ (1 << (rand() % 8)), near);
+		}
+		else if(roll == 1 && damage > 0){
+			//a dropped byte
+		}
+		else if(roll == 2){
+			//noise on the line, a byte that was never sent
+			receive(rand() & 0xFF, near);
+			receive(packet[k], near);
+		}
+		else{
+			receive(packet[k], near);
+		}
+	}
+}
+
+/*	streams every set but the skipped ones, closing packets as the encoder asks
+*/
+static void stream(int damage){
+	encoder.reset();
+	decoder.reset();
+	received = 0;
+	wrong = 0;
+	sent = 0;
+	packets = 0;
+	
+	for(int i = 0; i < SETS; i ++){
+		//a gap in the set numbers, as left by an overrun
+		if(i % 10000 == 5000){
+			continue;
+		}
+		if(!encoder.add(sentX[i], sentY[i], sentZ[i], (uint16_t)i)){
+			send(damage, i);
+			encoder.add(sentX[i], sentY[i], sentZ[i], (uint16_t)i);
+		}
+		sent ++;
+	}
+	send(damage, SETS - 1);
+}
+
+int main(){
+	srand(25);
+	
+	//noisy, steady, full scale and stepping inputs
+	for(int i = 0; i < SETS; i ++){
+		sentX[i] = rand() % 4096 - 2048;
+		sentY[i] = (i % 100) * 5 - 250;
+		sentZ[i] = (i / 1000) % 2 == 0 ? 1000 + rand() % 9 - 4 : (i % 2 == 0 ? 32767 : -32768);
+	}
+	
+	//as sent, every set comes out and only the skipped sets are missing
+	stream(0);
+	printf("clean: %d packets, %d of %d sets, %lu lost sets\n", packets, received, sent,
+		(unsigned long)decoder.getLostSets());
+	CHECK(wrong == 0);
+	CHECK(received == sent);
+	CHECK(decoder.getPackets() == (uint32_t)packets);
+	CHECK(decoder.getLostSets() == (uint32_t)(SETS - sent));
+	CHECK(decoder.getCRCErrors() == 0 && decoder.getSkipped() == 0);
+	CHECK(decoder.getLostPackets() == 0);
+	
+	//about one packet in ten damaged
+	stream(30);
+	printf("damaged: %lu of %d packets, %lu lost, %lu CRC errors, %lu bytes skipped, %d sets wrong\n",
+		(unsigned long)decoder.getPackets(), packets, (unsigned long)decoder.getLostPackets(),
+		(unsigned long)decoder.getCRCErrors(), (unsigned long)decoder.getSkipped(), wrong);
+	CHECK(wrong == 0);
+	CHECK(decoder.getPackets() < (uint32_t)packets);
+	CHECK(decoder.getPackets() > (uint32_t)packets * 3 / 4);
+	//a lost packet is counted from the gap it leaves, this seed keeps the last one
+	CHECK(decoder.getPackets() + decoder.getLostPackets() == (uint32_t)packets);
+	CHECK(decoder.getCRCErrors() > 0);
+	CHECK(decoder.getSkipped() > 0);
+	
+	return hostTestResult();
+}
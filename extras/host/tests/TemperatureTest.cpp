@@ -0,0 +1,152 @@
+/************************************************************************/
+/*																		*/
+/*	TemperatureTest.cpp	--	Temperature in and beside the FIFO			*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Runs setTemperatureFIFO() against the ADXL362 model. With 1 the		*/
+/*	FIFO holds x, y, z, t sets and tempFIFO keeps step with xFIFO.		*/
+/*	With N > 1 the FIFO holds x, y, z sets and the driver reads			*/
+/*	TEMP_L and TEMP_H once per N stored sets. Switching clears the		*/
+/*	FIFO and rounds the watermark to the new set size					*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ACL2mock.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+/*	model that counts register reads starting at TEMP_L
+*/
+class CountingSim : public ADXL362sim
+{
+	public:
+		CountingSim(){
+			position = 0;
+			command = 0;
+			tempReads = 0;
+		}
+
+		virtual void select(){
+			position = 0;
+			ADXL362sim::select();
+		}
+
+		virtual uint8_t transfer(uint8_t data){
+			if(position == 0){
+				command = data;
+			}
+			if(position == 1 && command == READ && data == TEMP_L){
+				tempReads ++;
+			}
+			position ++;
+			return ADXL362sim::transfer(data);
+		}
+
+		int tempReads;
+
+	private:
+		int position;
+		uint8_t command;
+};
+
+static CountingSim sim;
+static ACL2mock bus(&sim);
+static ACL2 acl;
+
+/*	watermark in entries as written to FIFO_SAMPLES and FIFO_CONTROL
+*/
+static int watermark(){
+	return sim.getRegister(FIFO_SAMPLES) | ((sim.getRegister(FIFO_CONTROL) & FIFO_AH) ? 0x100 : 0);
+}
+
+/*	throws the stored sets and temperatures away
+*/
+static void drop(){
+	acl.xFIFO.empty();
+	acl.yFIFO.empty();
+	acl.zFIFO.empty();
+	acl.tempFIFO.empty();
+}
+
+int main(){
+	int reads = 0;
+	int entries = 0;
+	bool same = true;
+
+	hostUseVirtualClock(true);
+	sim.setTemperature(351);
+
+	acl.begin(&bus);
+	acl.initFIFO();
+	acl.setWatermark(400);
+	CHECK(watermark() == 399);
+
+	//temperature in the FIFO: four entries a set, the watermark goes down to 396
+	delay(100);
+	acl.setTemperatureFIFO(1);
+	CHECK(sim.getRegister(FIFO_CONTROL) & FIFO_TEMP);
+	CHECK(sim.getFIFOentries() == 0);
+	CHECK(watermark() == 396);
+	delay(100);
+	sim.update();
+	entries = sim.getFIFOentries();
+	CHECK(entries % 4 == 0 && entries >= 36 && entries <= 40);
+
+	reads = sim.tempReads;
+	for(int k = 0; k < 5; k ++){
+		acl.fillFIFO();
+		same = same && acl.tempFIFO.size() == acl.xFIFO.size();
+		same = same && acl.zFIFO.size() == acl.xFIFO.size();
+		delay(70);
+	}
+	CHECK(same);
+	CHECK(acl.xFIFO.size() >= 37 && acl.xFIFO.size() <= 39);
+	CHECK(acl.tempFIFO.front() == 351 && acl.tempFIFO.back() == 351);
+	CHECK(sim.tempReads == reads);
+
+	//one register read per 8 sets, drained a set at a time
+	drop();
+	acl.setTemperatureFIFO(8);
+	CHECK(!(sim.getRegister(FIFO_CONTROL) & FIFO_TEMP));
+	CHECK(sim.getFIFOentries() == 0);
+	CHECK(watermark() == 396);
+
+	reads = sim.tempReads;
+	for(int k = 0; k < 40; k ++){
+		delay(10);
+		acl.fillFIFO();
+	}
+	CHECK(acl.xFIFO.size() == 40);
+	CHECK(sim.tempReads - reads == 5);
+	CHECK(acl.tempFIFO.size() == 5);
+	CHECK(acl.tempFIFO.back() == 351);
+
+	//no temperature entries go into the FIFO
+	acl.fillFIFO();
+	delay(100);
+	sim.update();
+	entries = sim.getFIFOentries();
+	CHECK(entries % 3 == 0 && entries >= 27 && entries <= 30);
+
+	//0 keeps three entry sets, so neither the FIFO nor the watermark change.
+	//Going back to 1 clears the FIFO and rounds the watermark down to four entries
+	acl.setWatermark(400);
+	CHECK(watermark() == 399);
+	acl.setTemperatureFIFO(0);
+	CHECK(sim.getFIFOentries() >= entries);
+	CHECK(watermark() == 399);
+	acl.setTemperatureFIFO(1);
+	CHECK(sim.getFIFOentries() == 0);
+	CHECK(watermark() == 396);
+
+	return hostTestResult();
+}
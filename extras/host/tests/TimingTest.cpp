@@ -0,0 +1,150 @@
+/************************************************************************/
+/*																		*/
+/*	TimingTest.cpp	--	Frame timestamps against the ADXL362 model		*/
+/*																		*/
+/************************************************************************/
+/*	Copyright (c) 2014, Digilent Inc. All rights reserved.				*/
+/************************************************************************/
+/*  Module Description:													*/
+/*																		*/
+/*	Built with ACL2_FRAME_TIME and ACL2_FRAME_SEQ. The model runs its	*/
+/*	oscillator fast, on time or slow and is drained at uneven			*/
+/*	intervals. The timestamps must rise by about one period per set,	*/
+/*	the measured period and drift must follow the model, the newest		*/
+/*	stamp must fall in the period before the drain, and sets lost to	*/
+/*	an overrun must leave matching gaps in the stamps and set numbers	*/
+/*																		*/
+/************************************************************************/
+
+#include "ACL2.h"
+#include "ADXL362sim.h"
+#include "HostTest.h"
+
+#include <stdlib.h>
+
+/* ------------------------------------------------------------ */
+/*					Local Procedures							*/
+/* ------------------------------------------------------------ */
+
+static ADXL362sim sim;
+
+/*	runs one ACL2 for drains drains at 100Hz with the model's oscillator off by ppm
+*/
+static void track(long ppm){
+	ACL2 acl;
+	long period = 10000 + 10000 * ppm / 1000000;	//true period in us
+	uint32_t lastTime = 0;
+	uint32_t lastSeq = 0;
+	bool first = true;
+	int backwards = 0;
+	int wild = 0;
+	int uneven = 0;
+	int late = 0;
+	unsigned r = 7;
+	
+	sim.setClockError(ppm);
+	acl.begin(SS);
+	acl.initFIFO();
+	
+	for(int k = 0; k < 1500; k ++){
+		//uneven gaps of 30 to 70ms between drains
+		r = r * 1103515245 + 12345;
+		delay(30 + (r >> 16) % 40);
+		acl.fillFIFO();
+		
+		while(acl.timeFIFO.size() > 0){
+			uint32_t time = acl.timeFIFO.pop_front();
+			uint32_t seq = acl.seqFIFO.pop_front();
+			
+			acl.xFIFO.pop_front();
+			acl.yFIFO.pop_front();
+			acl.zFIFO.pop_front();
+			if(!first){
+				long step = (int32_t)(time - lastTime);
+				
+				if(step <= 0){
+					backwards ++;
+				}
+				//while the period settles a drain may move the line by part of a period
+				if(seq != lastSeq + 1 || step < period / 2 || step > period * 3 / 2){
+					wild ++;
+				}
+				//once the period has settled, a few thousand sets in, the line only gets small nudges
+				if(k >= 500 && (step < period * 19 / 20 || step > period * 21 / 20)){
+					uneven ++;
+				}
+			}
+			first = false;
+			lastTime = time;
+			lastSeq = seq;
+		}
+		
+		//the newest set was converted in the period before the drain
+		if(k > 100 && ((int32_t)(micros() - lastTime) < 0 || (int32_t)(micros() - lastTime) > 2 * period)){
+			late ++;
+		}
+	}
+	
+	printf("%ld ppm: period %lu ns, drift %ld ppm, %d uneven steps, %d late\n", ppm,
+		(unsigned long)acl.getSamplePeriod(), acl.getDrift(), uneven, late);
+	CHECK(backwards == 0);
+	CHECK(wild == 0);
+	CHECK(uneven == 0);
+	CHECK(late == 0);
+	CHECK(labs((long)acl.getSamplePeriod() - period * 1000) <= period / 2);	//within 50ppm
+	CHECK(labs(acl.getDrift() - ppm) <= 100);
+}
+
+int main(){
+	ACL2 acl;
+	ACL2loss loss;
+	uint32_t lastTime = 0;
+	uint32_t lastSeq = 0;
+	bool first = true;
+	int gaps = 0;
+	int mismatched = 0;
+	
+	hostUseVirtualClock(true);
+	hostAttachDevice(SS, &sim);
+	
+	track(0);
+	track(-2000);
+	track(3000);
+	
+	//drains 2s apart overrun the 170 sets the FIFO holds at 100Hz
+	sim.setClockError(0);
+	acl.begin(SS);
+	acl.initFIFO();
+	for(int k = 0; k < 8; k ++){
+		delay(k % 2 == 0 ? 2000 : 500);
+		acl.fillFIFO();
+		while(acl.timeFIFO.size() > 0){
+			uint32_t time = acl.timeFIFO.pop_front();
+			uint32_t seq = acl.seqFIFO.pop_front();
+			
+			acl.xFIFO.pop_front();
+			acl.yFIFO.pop_front();
+			acl.zFIFO.pop_front();
+			if(!first && seq != lastSeq + 1){
+				//the stamps skip the lost sets too, to within a couple of periods
+				long expected = (long)(seq - lastSeq) * 10000;
+				
+				gaps ++;
+				if(labs((int32_t)(time - lastTime) - expected) > 20000){
+					mismatched ++;
+				}
+			}
+			first = false;
+			lastTime = time;
+			lastSeq = seq;
+		}
+	}
+	acl.getLoss(&loss);
+	printf("overrun: %d gaps, %lu overruns, %d mismatched\n", gaps, (unsigned long)loss.overruns, mismatched);
+	//the first drain overruns before any set is stored, so it leaves no gap
+	CHECK(gaps > 0);
+	CHECK((uint32_t)gaps + 1 == loss.overruns);
+	CHECK(mismatched == 0);
+	
+	return hostTestResult();
+}